@@ -0,0 +1,211 @@
+#include "ActivityLogger.h"
+#include "DatabaseManager.h"
+#include <QDeadlineTimer>
+#include <QDebug>
+#include <QMutexLocker>
+
+ActivityLogger& ActivityLogger::instance() {
+    static ActivityLogger instance;
+    return instance;
+}
+
+ActivityLogger::ActivityLogger()
+    : m_state(Idle)
+    , m_writer(nullptr)
+    , m_head(&m_stub)
+    , m_tail(&m_stub)
+    , m_pending(0)
+    , m_dropped(0)
+    , m_written(0)
+    , m_logged(0)
+{
+}
+
+ActivityLogger::~ActivityLogger() {
+    if (m_state.loadAcquire() == Running) {
+        shutdown();
+    }
+    while (Node* node = pop()) {
+        delete node;
+    }
+}
+
+void ActivityLogger::start(const Options& options) {
+    if (m_state.loadAcquire() != Idle) {
+        return;
+    }
+
+    m_options = options;
+    m_options.flushIntervalMs = qMax(1, m_options.flushIntervalMs);
+    m_options.batchSize = qMax(1, m_options.batchSize);
+    m_options.capacity = qMax(m_options.batchSize, m_options.capacity);
+
+    m_writer = QThread::create([this]() {
+        writerLoop();
+    });
+    m_writer->setObjectName("ActivityLogger");
+    m_state.storeRelease(Running);
+    m_writer->start();
+}
+
+// ==================== Producers ====================
+
+bool ActivityLogger::log(int userId, const QString& actionType, const QString& actionDetails) {
+    // Counted before the state check so the writer cannot finish its last
+    // pass between the two and leave this entry behind
+    const int pending = m_pending.fetchAndAddOrdered(1) + 1;
+    if (m_state.loadAcquire() == Stopped) {
+        m_pending.fetchAndSubOrdered(1);
+        qWarning() << "Activity logged after shutdown was discarded:" << actionType;
+        return false;
+    }
+
+    Node* node = new Node;
+    node->entry.userId = userId;
+    node->entry.actionType = actionType;
+    node->entry.actionDetails = actionDetails;
+    node->entry.createdAt = QDateTime::currentDateTime();
+
+    m_logged.fetchAndAddOrdered(1);
+    push(node);
+
+    if (pending == m_options.batchSize) {
+        m_wake.release();
+    } else if (pending > m_options.capacity) {
+        waitForRoom();
+    }
+    return true;
+}
+
+void ActivityLogger::push(Node* node) {
+    node->next.storeRelaxed(nullptr);
+    Node* previous = m_head.fetchAndStoreOrdered(node);
+    // Until this store the writer sees the queue end at previous
+    previous->next.storeRelease(node);
+}
+
+void ActivityLogger::waitForRoom() {
+    QMutexLocker locker(&m_mutex);
+    while (m_pending.loadAcquire() > m_options.capacity && m_state.loadAcquire() == Running) {
+        m_wake.release();
+        m_progress.wait(&m_mutex, m_options.flushIntervalMs);
+    }
+}
+
+bool ActivityLogger::flush(int timeoutMs) {
+    const quint64 target = m_logged.loadAcquire();
+    QDeadlineTimer deadline(timeoutMs);
+
+    QMutexLocker locker(&m_mutex);
+    while (m_written < target && m_state.loadAcquire() == Running) {
+        m_wake.release();
+        if (!m_progress.wait(&m_mutex, deadline)) {
+            break;
+        }
+    }
+    return m_written >= target;
+}
+
+void ActivityLogger::shutdown() {
+    const int previous = m_state.fetchAndStoreOrdered(Stopped);
+    if (previous == Stopped) {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        m_progress.wakeAll();
+    }
+
+    if (previous == Running) {
+        m_wake.release();
+        m_writer->wait();
+        delete m_writer;
+        m_writer = nullptr;
+    } else {
+        // Never started: write what was queued on this thread
+        writerLoop();
+    }
+}
+
+// ==================== Writer ====================
+
+ActivityLogger::Node* ActivityLogger::pop() {
+    Node* tail = m_tail;
+    Node* next = tail->next.loadAcquire();
+
+    if (tail == &m_stub) {
+        if (!next) {
+            return nullptr;
+        }
+        m_tail = next;
+        tail = next;
+        next = next->next.loadAcquire();
+    }
+    if (next) {
+        m_tail = next;
+        return tail;
+    }
+
+    // tail is the last node, or a producer is between its two steps in push()
+    if (tail != m_head.loadAcquire()) {
+        return nullptr;
+    }
+    push(&m_stub);
+    next = tail->next.loadAcquire();
+    if (next) {
+        m_tail = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+void ActivityLogger::writerLoop() {
+    QVector<UserActivityLog> batch;
+    batch.reserve(m_options.batchSize);
+    int attempts = 0;
+
+    while (true) {
+        const bool stopping = m_state.loadAcquire() == Stopped;
+        if (!stopping && m_pending.loadAcquire() < m_options.batchSize) {
+            m_wake.tryAcquire(1, m_options.flushIntervalMs);
+        }
+        // Wake-ups that piled up meanwhile are all served by this pass
+        m_wake.tryAcquire(m_wake.available());
+
+        while (batch.size() < m_options.batchSize) {
+            Node* node = pop();
+            if (!node) {
+                break;
+            }
+            batch.append(std::move(node->entry));
+            delete node;
+        }
+
+        if (!batch.isEmpty()) {
+            if (DatabaseManager::instance().writeActivityLogs(batch)) {
+                finishBatch(batch.size());
+                batch.clear();
+                attempts = 0;
+            } else if (++attempts >= kMaxAttempts) {
+                qWarning() << "Dropping" << batch.size() << "activity log entries:"
+                           << DatabaseManager::instance().getLastError();
+                m_dropped.fetchAndAddOrdered(batch.size());
+                finishBatch(batch.size());
+                batch.clear();
+                attempts = 0;
+            }
+        }
+
+        if (stopping && batch.isEmpty() && m_pending.loadAcquire() == 0) {
+            break;
+        }
+    }
+}
+
+void ActivityLogger::finishBatch(int count) {
+    m_pending.fetchAndSubOrdered(count);
+
+    QMutexLocker locker(&m_mutex);
+    m_written += count;
+    m_progress.wakeAll();
+}
@@ -0,0 +1,87 @@
+#ifndef ACTIVITYLOGGER_H
+#define ACTIVITYLOGGER_H
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include "User.h"
+
+// Audit trail writer. log() only pushes the entry onto a lock-free queue that
+// any thread may feed; a background thread commits the queue in batches, one
+// transaction per batch, whenever batchSize entries are waiting or
+// flushIntervalMs has passed. Entries keep the time they were logged, not
+// the time they were written.
+//
+// If the writer falls behind and capacity entries are waiting, log() blocks
+// until a batch commits. shutdown() writes everything still queued.
+class ActivityLogger {
+public:
+    struct Options {
+        int flushIntervalMs = 200;
+        int batchSize = 64;
+        int capacity = 4096;
+    };
+
+    static ActivityLogger& instance();
+
+    // Entries logged before start() wait in the queue
+    void start(const Options& options = Options());
+
+    bool log(int userId, const QString& actionType, const QString& actionDetails);
+
+    // Waits until everything logged before the call is committed
+    bool flush(int timeoutMs = 5000);
+
+    // Commits what is queued and stops the writer (call before closing the database)
+    void shutdown();
+
+    int pendingCount() const { return m_pending.loadAcquire(); }
+    int droppedCount() const { return m_dropped.loadAcquire(); }
+
+private:
+    enum State { Idle, Running, Stopped };
+
+    // Intrusive node of a Vyukov MPSC queue: producers swap themselves in at
+    // m_head, the writer alone walks from m_tail
+    struct Node {
+        QAtomicPointer<Node> next;
+        UserActivityLog entry;
+    };
+
+    static constexpr int kMaxAttempts = 3;
+
+    ActivityLogger();
+    ~ActivityLogger();
+    ActivityLogger(const ActivityLogger&) = delete;
+    ActivityLogger& operator=(const ActivityLogger&) = delete;
+
+    void push(Node* node);
+    Node* pop();
+    void waitForRoom();
+    void writerLoop();
+    void finishBatch(int count);
+
+    Options m_options;
+    QAtomicInt m_state;
+    QThread* m_writer;
+
+    QAtomicPointer<Node> m_head;
+    Node* m_tail;
+    Node m_stub;
+
+    QAtomicInt m_pending;      // Logged but not yet committed (or dropped)
+    QAtomicInt m_dropped;
+    QSemaphore m_wake;
+
+    // Only touched once per batch, never by log() unless it has to wait
+    QMutex m_mutex;
+    QWaitCondition m_progress;
+    quint64 m_written;         // Entries committed or dropped so far
+    QAtomicInteger<quint64> m_logged;
+};
+
+#endif // ACTIVITYLOGGER_H
@@ -0,0 +1,192 @@
+#include "AsyncDatabase.h"
+#include <QThread>
+#include <QtGlobal>
+
+AsyncDatabase& AsyncDatabase::instance() {
+    static AsyncDatabase instance;
+    return instance;
+}
+
+AsyncDatabase::AsyncDatabase() {
+    // SQLite allows one writer at a time; a few readers is all WAL needs
+    m_pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 4));
+    m_pool.setObjectName("AsyncDatabase");
+}
+
+AsyncDatabase::~AsyncDatabase() {
+    shutdown();
+}
+
+void AsyncDatabase::shutdown() {
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+// ==================== Books ====================
+
+QFuture<QVector<Book>> AsyncDatabase::getAllBooks() {
+    return run<QVector<Book>>([](DatabaseManager& db) {
+        return db.getAllBooks();
+    });
+}
+
+QFuture<QVector<Book>> AsyncDatabase::searchBooks(const QString& searchTerm) {
+    return run<QVector<Book>>([searchTerm](DatabaseManager& db) {
+        return db.searchBooks(searchTerm);
+    });
+}
+
+QFuture<QVector<Book>> AsyncDatabase::getBooksByGrade(const QString& grade) {
+    return run<QVector<Book>>([grade](DatabaseManager& db) {
+        return db.getBooksByGrade(grade);
+    });
+}
+
+QFuture<Page<BookListRow>> AsyncDatabase::getBooksPage(DatabaseManager::BookSort sort,
+                                                       const PageCursor& after, int limit) {
+    return run<Page<BookListRow>>([sort, after, limit](DatabaseManager& db) {
+        return db.getBooksPage(sort, after, limit);
+    });
+}
+
+// ==================== Learners ====================
+
+QFuture<QVector<Learner>> AsyncDatabase::getAllLearners() {
+    return run<QVector<Learner>>([](DatabaseManager& db) {
+        return db.getAllLearners();
+    });
+}
+
+QFuture<QVector<Learner>> AsyncDatabase::searchLearners(const QString& searchTerm) {
+    return run<QVector<Learner>>([searchTerm](DatabaseManager& db) {
+        return db.searchLearners(searchTerm);
+    });
+}
+
+QFuture<QVector<Learner>> AsyncDatabase::getLearnersByGrade(const QString& grade) {
+    return run<QVector<Learner>>([grade](DatabaseManager& db) {
+        return db.getLearnersByGrade(grade);
+    });
+}
+
+QFuture<Page<Learner>> AsyncDatabase::getLearnersPage(DatabaseManager::LearnerSort sort,
+                                                      const PageCursor& after, int limit) {
+    return run<Page<Learner>>([sort, after, limit](DatabaseManager& db) {
+        return db.getLearnersPage(sort, after, limit);
+    });
+}
+
+// ==================== Transactions ====================
+
+QFuture<QVector<Transaction>> AsyncDatabase::getTransactionsByLearnerId(int learnerId,
+                                                                        DatabaseManager::HistoryScope scope) {
+    return run<QVector<Transaction>>([learnerId, scope](DatabaseManager& db) {
+        return db.getTransactionsByLearnerId(learnerId, scope);
+    });
+}
+
+QFuture<QVector<Transaction>> AsyncDatabase::getActiveTransactionsByLearnerId(int learnerId) {
+    return run<QVector<Transaction>>([learnerId](DatabaseManager& db) {
+        return db.getActiveTransactionsByLearnerId(learnerId);
+    });
+}
+
+QFuture<QVector<Transaction>> AsyncDatabase::getRecentTransactions(int limit) {
+    return run<QVector<Transaction>>([limit](DatabaseManager& db) {
+        return db.getRecentTransactions(limit);
+    });
+}
+
+QFuture<Page<Transaction>> AsyncDatabase::getTransactionsPage(const PageCursor& after, int limit,
+                                                              int learnerId, DatabaseManager::HistoryScope scope) {
+    return run<Page<Transaction>>([after, limit, learnerId, scope](DatabaseManager& db) {
+        return db.getTransactionsPage(after, limit, learnerId, scope);
+    });
+}
+
+QFuture<QVector<TransactionDetail>> AsyncDatabase::getRecentTransactionDetails(int limit) {
+    return run<QVector<TransactionDetail>>([limit](DatabaseManager& db) {
+        return db.getRecentTransactionDetails(limit);
+    });
+}
+
+QFuture<Page<TransactionDetail>> AsyncDatabase::getTransactionDetailsPage(const PageCursor& after, int limit,
+                                                                          int learnerId,
+                                                                          DatabaseManager::HistoryScope scope) {
+    return run<Page<TransactionDetail>>([after, limit, learnerId, scope](DatabaseManager& db) {
+        return db.getTransactionDetailsPage(after, limit, learnerId, scope);
+    });
+}
+
+// ==================== Maintenance ====================
+
+QFuture<int> AsyncDatabase::archiveClosedTransactions(const QDate& closedBefore) {
+    return run<int>([closedBefore](DatabaseManager& db) {
+        return db.archiveClosedTransactions(closedBefore);
+    });
+}
+
+QFuture<int> AsyncDatabase::rollActivityLogPartitions(int keepMonths) {
+    return run<int>([keepMonths](DatabaseManager& db) {
+        return db.rollActivityLogPartitions(QDate::currentDate(), keepMonths);
+    });
+}
+
+// ==================== Circulation ====================
+
+QFuture<QVector<DatabaseManager::BorrowResult>> AsyncDatabase::borrowBooksBatch(
+    const QVector<DatabaseManager::BorrowRequest>& requests, const QDate& borrowDate) {
+    return run<QVector<DatabaseManager::BorrowResult>>([requests, borrowDate](DatabaseManager& db) {
+        return db.borrowBooksBatch(requests, borrowDate);
+    });
+}
+
+// ==================== Imports ====================
+
+QFuture<BookCsvImporter::Report> AsyncDatabase::importBooksCsv(const QString& filePath,
+                                                               const BookCsvImporter::Options& options,
+                                                               const BookCsvImporter::CancelCheck& isCancelled) {
+    return QtConcurrent::run(&m_pool, [filePath, options, isCancelled](QPromise<BookCsvImporter::Report>& promise) {
+        promise.setProgressRange(0, 1000);
+
+        BookCsvImporter importer(options);
+        BookCsvImporter::Report report = importer.run(
+            filePath,
+            isCancelled,
+            [&promise](const BookCsvImporter::Progress& progress) {
+                int permille = progress.totalBytes > 0 ? int(progress.bytesRead * 1000 / progress.totalBytes) : 0;
+                promise.setProgressValueAndText(qMin(permille, 1000),
+                    QString("%1 rows read, %2 rows/s").arg(progress.rowsRead).arg(qRound(progress.rowsPerSecond)));
+            });
+
+        promise.addResult(report);
+    });
+}
+
+QFuture<LearnerRosterImporter::Report> AsyncDatabase::importLearnerRoster(
+    const QString& filePath, const LearnerRosterImporter::Options& options,
+    const LearnerRosterImporter::CancelCheck& isCancelled) {
+    return QtConcurrent::run(&m_pool, [filePath, options, isCancelled](QPromise<LearnerRosterImporter::Report>& promise) {
+        promise.setProgressRange(0, 1000);
+
+        LearnerRosterImporter importer(options);
+        LearnerRosterImporter::Report report = importer.run(
+            filePath,
+            isCancelled,
+            [&promise](const LearnerRosterImporter::Progress& progress) {
+                int permille = progress.totalBytes > 0 ? int(progress.bytesRead * 1000 / progress.totalBytes) : 0;
+                promise.setProgressValueAndText(qMin(permille, 1000),
+                    QString("%1 rows read, %2 rows/s").arg(progress.rowsRead).arg(qRound(progress.rowsPerSecond)));
+            });
+
+        promise.addResult(report);
+    });
+}
+
+// ==================== Dashboard ====================
+
+QFuture<DatabaseManager::DashboardStats> AsyncDatabase::getDashboardStats() {
+    return run<DatabaseManager::DashboardStats>([](DatabaseManager& db) {
+        return db.getDashboardStats();
+    });
+}
@@ -0,0 +1,97 @@
+#ifndef ASYNCDATABASE_H
+#define ASYNCDATABASE_H
+
+#include <QFuture>
+#include <QPromise>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <functional>
+#include "DatabaseManager.h"
+#include "BookCsvImporter.h"
+#include "LearnerRosterImporter.h"
+
+// Runs DatabaseManager calls on a small worker pool so the GUI thread never
+// waits on SQLite. Each worker uses its own pooled connection. Attach results
+// with future.then(context, ...) to get them back on the GUI thread.
+//
+// Cancelling a future drops the request if it has not started yet and
+// discards its result otherwise; a query already running is not interrupted.
+class AsyncDatabase {
+public:
+    static AsyncDatabase& instance();
+
+    // Books
+    QFuture<QVector<Book>> getAllBooks();
+    QFuture<QVector<Book>> searchBooks(const QString& searchTerm);
+    QFuture<QVector<Book>> getBooksByGrade(const QString& grade);
+    QFuture<Page<BookListRow>> getBooksPage(DatabaseManager::BookSort sort, const PageCursor& after, int limit);
+
+    // Learners
+    QFuture<QVector<Learner>> getAllLearners();
+    QFuture<QVector<Learner>> searchLearners(const QString& searchTerm);
+    QFuture<QVector<Learner>> getLearnersByGrade(const QString& grade);
+    QFuture<Page<Learner>> getLearnersPage(DatabaseManager::LearnerSort sort, const PageCursor& after, int limit);
+
+    // Transactions
+    QFuture<QVector<Transaction>> getTransactionsByLearnerId(
+        int learnerId, DatabaseManager::HistoryScope scope = DatabaseManager::HistoryScope::Current);
+    QFuture<QVector<Transaction>> getActiveTransactionsByLearnerId(int learnerId);
+    QFuture<QVector<Transaction>> getRecentTransactions(int limit = 10);
+    QFuture<Page<Transaction>> getTransactionsPage(
+        const PageCursor& after, int limit, int learnerId = -1,
+        DatabaseManager::HistoryScope scope = DatabaseManager::HistoryScope::Current);
+    QFuture<QVector<TransactionDetail>> getRecentTransactionDetails(int limit = 10);
+    QFuture<Page<TransactionDetail>> getTransactionDetailsPage(
+        const PageCursor& after, int limit, int learnerId = -1,
+        DatabaseManager::HistoryScope scope = DatabaseManager::HistoryScope::Current);
+
+    // Maintenance
+    QFuture<int> archiveClosedTransactions(const QDate& closedBefore);
+    QFuture<int> rollActivityLogPartitions(int keepMonths);
+
+    // Circulation
+    QFuture<QVector<DatabaseManager::BorrowResult>> borrowBooksBatch(
+        const QVector<DatabaseManager::BorrowRequest>& requests, const QDate& borrowDate);
+
+    // Imports report progress in per mille of the file read, with a rows/s
+    // text. Stop them through isCancelled rather than QFuture::cancel(), which
+    // would discard the report of what was already committed.
+    QFuture<BookCsvImporter::Report> importBooksCsv(const QString& filePath, const BookCsvImporter::Options& options,
+                                                    const BookCsvImporter::CancelCheck& isCancelled);
+    QFuture<LearnerRosterImporter::Report> importLearnerRoster(const QString& filePath,
+                                                               const LearnerRosterImporter::Options& options,
+                                                               const LearnerRosterImporter::CancelCheck& isCancelled);
+
+    // Dashboard
+    QFuture<DatabaseManager::DashboardStats> getDashboardStats();
+
+    // Any other DatabaseManager call
+    template <typename T>
+    QFuture<T> run(std::function<T(DatabaseManager&)> work);
+
+    // Drops queued requests and waits for running ones (call before closing the database)
+    void shutdown();
+
+private:
+    AsyncDatabase();
+    ~AsyncDatabase();
+    AsyncDatabase(const AsyncDatabase&) = delete;
+    AsyncDatabase& operator=(const AsyncDatabase&) = delete;
+
+    QThreadPool m_pool;
+};
+
+template <typename T>
+QFuture<T> AsyncDatabase::run(std::function<T(DatabaseManager&)> work) {
+    return QtConcurrent::run(&m_pool, [work](QPromise<T>& promise) {
+        if (promise.isCanceled()) {
+            return;
+        }
+        T result = work(DatabaseManager::instance());
+        if (!promise.isCanceled()) {
+            promise.addResult(std::move(result));
+        }
+    });
+}
+
+#endif // ASYNCDATABASE_H
@@ -0,0 +1,372 @@
+#include "BackupService.h"
+#include "AsyncDatabase.h"
+#include "DatabaseManager.h"
+#include <QAtomicInt>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVector>
+
+namespace {
+
+constexpr int kScheduleCheckMs = 10 * 60 * 1000;
+constexpr int kProgressPollMs = 250;
+
+// Names sort by time: library_system-20260117-153000.db
+const char* const kTimestampFormat = "yyyyMMdd-HHmmss";
+
+QString backupNameFilter(const QString& baseName, const QString& suffix) {
+    return baseName + "-????????-??????." + suffix;
+}
+
+qint64 fileSize(const QString& path) {
+    QFileInfo info(path);
+    return info.exists() ? info.size() : 0;
+}
+
+bool replaceFile(const QString& from, const QString& to, QString* error) {
+    QFile::remove(to);
+    if (!QFile::copy(from, to)) {
+        *error = "Failed to copy " + from + " to " + to;
+        return false;
+    }
+    return true;
+}
+
+}
+
+BackupService& BackupService::instance() {
+    static BackupService instance;
+    return instance;
+}
+
+BackupService::BackupService()
+    : m_generations(7)
+    , m_intervalHours(0)
+    , m_running(false)
+    , m_expectedBytes(0)
+{
+    m_scheduleTimer.setInterval(kScheduleCheckMs);
+    connect(&m_scheduleTimer, &QTimer::timeout, this, &BackupService::checkSchedule);
+
+    m_progressTimer.setInterval(kProgressPollMs);
+    connect(&m_progressTimer, &QTimer::timeout, this, &BackupService::pollProgress);
+}
+
+void BackupService::setBackupDirectory(const QString& directory) {
+    m_directory = directory;
+}
+
+void BackupService::setGenerations(int generations) {
+    m_generations = qMax(1, generations);
+}
+
+void BackupService::setSchedule(int intervalHours) {
+    m_intervalHours = qMax(0, intervalHours);
+    if (m_intervalHours == 0) {
+        m_scheduleTimer.stop();
+        return;
+    }
+    m_scheduleTimer.start();
+    // Catch up soon after start-up rather than a full check interval later
+    QTimer::singleShot(60 * 1000, this, &BackupService::checkSchedule);
+}
+
+void BackupService::checkSchedule() {
+    if (m_running || m_intervalHours == 0) {
+        return;
+    }
+    QDateTime last = lastBackupTime();
+    if (!last.isValid() || last.secsTo(QDateTime::currentDateTime()) >= qint64(m_intervalHours) * 3600) {
+        backupNow();
+    }
+}
+
+QFuture<BackupService::Result> BackupService::backupNow() {
+    if (m_running) {
+        return m_current;
+    }
+
+    const QString dbPath = DatabaseManager::instance().getDatabase().databaseName();
+    const QFileInfo dbInfo(dbPath);
+    const QString directory = m_directory.isEmpty() ? dbInfo.absoluteDir().filePath("backups") : m_directory;
+    const QString targetPath = QDir(directory).filePath(
+        dbInfo.completeBaseName() + "-" + QDateTime::currentDateTime().toString(kTimestampFormat) + "."
+        + dbInfo.suffix());
+    const int generations = m_generations;
+
+    m_running = true;
+    m_targetPath = targetPath;
+    m_expectedBytes = fileSize(dbPath) + fileSize(DatabaseManager::archivePathFor(dbPath));
+    m_progressTimer.start();
+    emit backupStarted();
+    emit backupProgress(0);
+
+    m_current = AsyncDatabase::instance().run<Result>([targetPath, generations](DatabaseManager&) {
+        return createBackup(targetPath, generations);
+    });
+
+    m_current.then(this, [this](const Result& result) {
+        m_progressTimer.stop();
+        m_running = false;
+        m_targetPath.clear();
+
+        if (result.success) {
+            emit backupProgress(100);
+            qDebug() << "Backup written to" << result.path << "in" << result.elapsedMs << "ms";
+        } else {
+            qWarning() << "Backup failed:" << result.error;
+        }
+        emit backupFinished(result);
+    });
+
+    return m_current;
+}
+
+void BackupService::pollProgress() {
+    if (m_targetPath.isEmpty() || m_expectedBytes <= 0) {
+        return;
+    }
+    // VACUUM INTO writes the copy front to back, so its size tracks progress.
+    // The last few percent are the integrity check.
+    qint64 written = fileSize(partialPath(m_targetPath))
+                     + fileSize(partialPath(DatabaseManager::archivePathFor(m_targetPath)));
+    emit backupProgress(int(qMin<qint64>(95, written * 95 / m_expectedBytes)));
+}
+
+// Runs on a worker connection. VACUUM INTO reads one snapshot, so in WAL mode
+// the desk's writes carry on while it copies.
+BackupService::Result BackupService::createBackup(const QString& targetPath, int generations) {
+    QElapsedTimer timer;
+    timer.start();
+
+    Result result;
+    result.path = targetPath;
+
+    QFileInfo target(targetPath);
+    if (!QDir().mkpath(target.absolutePath())) {
+        result.error = "Cannot create backup directory " + target.absolutePath();
+        return result;
+    }
+
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    bool hasArchive = query.exec("SELECT 1 FROM pragma_database_list WHERE name = 'archive'") && query.next();
+    query.finish();
+
+    // Main first, archive second: the archiver copies before it deletes, so a
+    // loan moved in between shows up twice at worst, never not at all
+    QStringList files = { targetPath };
+    if (hasArchive) {
+        files << DatabaseManager::archivePathFor(targetPath);
+    }
+
+    for (int i = 0; i < files.size(); ++i) {
+        const QString part = partialPath(files.at(i));
+        QFile::remove(part);
+
+        query.prepare(i == 0 ? "VACUUM main INTO :path" : "VACUUM archive INTO :path");
+        query.bindValue(":path", part);
+        if (!query.exec()) {
+            result.error = "Backup copy failed: " + query.lastError().text();
+        } else if (!verify(part, &result.error)) {
+            result.error = "Backup failed verification: " + result.error;
+        }
+        query.finish();
+
+        if (!result.error.isEmpty()) {
+            for (const QString& file : files) {
+                QFile::remove(partialPath(file));
+            }
+            return result;
+        }
+    }
+
+    // Only verified copies take a generation's place
+    for (const QString& file : files) {
+        QFile::remove(file);
+        if (!QFile::rename(partialPath(file), file)) {
+            result.error = "Failed to finish " + file;
+            return result;
+        }
+        result.bytes += fileSize(file);
+    }
+
+    rotate(targetPath, generations);
+
+    result.success = true;
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+bool BackupService::verify(const QString& path, QString* error) {
+    static QAtomicInt nextId;
+    const QString connectionName = QString("lms_backup_verify_%1").arg(nextId.fetchAndAddOrdered(1));
+
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(path);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+        if (!db.open()) {
+            *error = db.lastError().text();
+        } else {
+            QSqlQuery query(db);
+            if (!query.exec("PRAGMA integrity_check")) {
+                *error = query.lastError().text();
+            } else {
+                QStringList problems;
+                while (query.next()) {
+                    problems << query.value(0).toString();
+                }
+                ok = problems == QStringList { "ok" };
+                if (!ok) {
+                    *error = problems.mid(0, 5).join("; ");
+                }
+            }
+            query.finish();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+void BackupService::rotate(const QString& newestPath, int generations) {
+    QFileInfo newest(newestPath);
+    QDir dir = newest.absoluteDir();
+    // Strip the "-yyyyMMdd-HHmmss" stamp to get the database's base name back
+    QString baseName = newest.completeBaseName().section('-', 0, -3);
+    QStringList names = dir.entryList({ backupNameFilter(baseName, newest.suffix()) }, QDir::Files,
+                                      QDir::Name | QDir::Reversed);
+
+    for (int i = generations; i < names.size(); ++i) {
+        QString path = dir.filePath(names.at(i));
+        QFile::remove(path);
+        QFile::remove(DatabaseManager::archivePathFor(path));
+    }
+}
+
+QStringList BackupService::backups() const {
+    QString dbPath = DatabaseManager::instance().getDatabase().databaseName();
+    QFileInfo dbInfo(dbPath);
+    QDir dir(m_directory.isEmpty() ? dbInfo.absoluteDir().filePath("backups") : m_directory);
+
+    QStringList paths;
+    const QStringList names = dir.entryList({ backupNameFilter(dbInfo.completeBaseName(), dbInfo.suffix()) },
+                                            QDir::Files, QDir::Name | QDir::Reversed);
+    for (const QString& name : names) {
+        paths << dir.filePath(name);
+    }
+    return paths;
+}
+
+QDateTime BackupService::lastBackupTime() const {
+    QStringList paths = backups();
+    return paths.isEmpty() ? QDateTime() : QFileInfo(paths.first()).lastModified();
+}
+
+bool BackupService::stageRestore(const QString& backupPath, QString* error) {
+    if (!verify(backupPath, error)) {
+        *error = "The backup failed its integrity check: " + *error;
+        return false;
+    }
+
+    const QString dbPath = DatabaseManager::instance().getDatabase().databaseName();
+    const QString backupArchive = DatabaseManager::archivePathFor(backupPath);
+    const QString liveArchive = DatabaseManager::archivePathFor(dbPath);
+
+    if (QFile::exists(backupArchive) && !verify(backupArchive, error)) {
+        *error = "The backup's archive failed its integrity check: " + *error;
+        return false;
+    }
+
+    // Archive first: a staged main file means the whole set is staged. With
+    // no archive in the backup none is staged, and the restore moves the live
+    // archive aside so it can't disagree with the restored loans.
+    QFile::remove(stagedPath(dbPath));
+    QFile::remove(stagedPath(liveArchive));
+    if (QFile::exists(backupArchive) && !replaceFile(backupArchive, stagedPath(liveArchive), error)) {
+        return false;
+    }
+    if (!replaceFile(backupPath, stagedPath(dbPath), error)) {
+        QFile::remove(stagedPath(liveArchive));
+        return false;
+    }
+    return true;
+}
+
+// The database and its archive are swapped as one set. Every live file is
+// renamed aside first and every staged copy renamed in; any failure undoes
+// all the renames so far. Only then does the set replace the previous
+// *.before-restore files.
+bool BackupService::applyPendingRestore(const QString& dbPath, QString* error) {
+    const QString archivePath = DatabaseManager::archivePathFor(dbPath);
+    if (!QFile::exists(stagedPath(dbPath))) {
+        return true;
+    }
+
+    QStringList live;
+    for (const QString& path : { dbPath, archivePath }) {
+        for (const QString& extra : { QString(), QString("-wal"), QString("-shm") }) {
+            live << path + extra;
+        }
+    }
+
+    for (const QString& path : live) {
+        if (QFile::exists(replacedPath(path))) {
+            *error = "An earlier restore was interrupted; the database it replaced is still at "
+                     + replacedPath(path) + ". Move it back to " + path + " before restarting.";
+            return false;
+        }
+    }
+
+    QVector<QPair<QString, QString>> moves;
+    auto move = [&moves, error](const QString& from, const QString& to) {
+        if (!QFile::rename(from, to)) {
+            *error = "Cannot move " + from + " to " + to + " for the restore";
+            return false;
+        }
+        moves.append({ from, to });
+        return true;
+    };
+
+    bool ok = true;
+    for (const QString& path : live) {
+        if (ok && QFile::exists(path)) {
+            ok = move(path, replacedPath(path));
+        }
+    }
+    for (const QString& path : { dbPath, archivePath }) {
+        if (ok && QFile::exists(stagedPath(path))) {
+            ok = move(stagedPath(path), path);
+        }
+    }
+
+    if (!ok) {
+        // Newest first, so each file goes back to a free name
+        for (int i = moves.size() - 1; i >= 0; --i) {
+            if (!QFile::rename(moves.at(i).second, moves.at(i).first)) {
+                *error += "; could not move " + moves.at(i).second + " back to " + moves.at(i).first;
+            }
+        }
+        return false;
+    }
+
+    // The swap is done; the set it replaced becomes the new *.before-restore
+    for (const QString& path : live) {
+        const QString previous = path + ".before-restore";
+        QFile::remove(previous);
+        if (QFile::exists(replacedPath(path)) && !QFile::rename(replacedPath(path), previous)) {
+            qWarning() << "Replaced database file left at" << replacedPath(path);
+        }
+    }
+
+    qDebug() << "Restored database from staged backup";
+    return true;
+}
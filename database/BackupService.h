@@ -0,0 +1,86 @@
+#ifndef BACKUPSERVICE_H
+#define BACKUPSERVICE_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QFuture>
+#include <QStringList>
+#include <QTimer>
+
+// Online backups of the library database (and its transaction archive) while
+// the desk keeps working. Each backup is a VACUUM INTO on a worker connection:
+// it copies one consistent WAL snapshot without blocking writers, is checked
+// with PRAGMA integrity_check and only then joins the rotation, which keeps
+// the newest N generations.
+//
+// Restores are staged: a verified backup is copied next to the database and
+// swapped in by applyPendingRestore() on the next start, before any
+// connection is open.
+class BackupService : public QObject {
+    Q_OBJECT
+
+public:
+    struct Result {
+        bool success = false;
+        QString path;
+        qint64 bytes = 0;
+        qint64 elapsedMs = 0;
+        QString error;
+    };
+
+    static BackupService& instance();
+
+    void setBackupDirectory(const QString& directory);
+    QString backupDirectory() const { return m_directory; }
+    void setGenerations(int generations);
+    int generations() const { return m_generations; }
+
+    // Backs up whenever the newest backup is older than intervalHours; 0 turns it off
+    void setSchedule(int intervalHours);
+
+    QFuture<Result> backupNow();
+    bool isRunning() const { return m_running; }
+
+    // Newest first
+    QStringList backups() const;
+    QDateTime lastBackupTime() const;
+
+    // Verifies the backup and stages it for the next start. A backup taken
+    // without an archive restores with an empty one.
+    bool stageRestore(const QString& backupPath, QString* error);
+    // Swaps a staged restore in; call before DatabaseManager::initialize().
+    // On failure the live files are left as they were.
+    static bool applyPendingRestore(const QString& dbPath, QString* error);
+
+signals:
+    void backupStarted();
+    void backupProgress(int percent);
+    void backupFinished(const BackupService::Result& result);
+
+private:
+    BackupService();
+    BackupService(const BackupService&) = delete;
+    BackupService& operator=(const BackupService&) = delete;
+
+    static Result createBackup(const QString& targetPath, int generations);
+    static bool verify(const QString& path, QString* error);
+    static void rotate(const QString& newestPath, int generations);
+    static QString stagedPath(const QString& path) { return path + ".restore"; }
+    static QString partialPath(const QString& path) { return path + ".part"; }
+    static QString replacedPath(const QString& path) { return path + ".replaced"; }
+
+    void checkSchedule();
+    void pollProgress();
+
+    QString m_directory;
+    int m_generations;
+    int m_intervalHours;
+    bool m_running;
+    QFuture<Result> m_current;
+    QString m_targetPath;      // Backup in progress; its .part files show how far it got
+    qint64 m_expectedBytes;
+    QTimer m_scheduleTimer;
+    QTimer m_progressTimer;
+};
+
+#endif // BACKUPSERVICE_H
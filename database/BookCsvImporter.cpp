@@ -0,0 +1,342 @@
+#include "BookCsvImporter.h"
+#include "DatabaseManager.h"
+#include "CsvReader.h"
+#include "LibraryStatistics.h"
+#include <QElapsedTimer>
+#include <QSqlError>
+
+namespace {
+
+// SQLite's default host-parameter limit in older builds
+constexpr int kMaxBoundValues = 999;
+
+// "R 149,95", "149.95" and "" (no price) are all accepted
+double parsePrice(QString text, bool* ok) {
+    text.remove(' ');
+    if (text.startsWith('R', Qt::CaseInsensitive)) {
+        text.remove(0, 1);
+    }
+    if (text.isEmpty()) {
+        *ok = true;
+        return 0.0;
+    }
+    if (!text.contains('.')) {
+        text.replace(',', '.');
+    } else {
+        text.remove(',');
+    }
+    double price = text.toDouble(ok);
+    *ok = *ok && price >= 0.0;
+    return price;
+}
+
+QString insertSql(int rows) {
+    QStringList values;
+    for (int i = 0; i < rows; ++i) {
+        values << "(?, ?, ?, ?, ?, ?, ?, 'Available')";
+    }
+    // OR IGNORE: a code added by another desk mid-import is skipped, not fatal
+    return "INSERT OR IGNORE INTO books (book_code, isbn, title, author, subject, grade, price, status) VALUES " +
+           values.join(", ");
+}
+
+}
+
+BookCsvImporter::ColumnMapping BookCsvImporter::ColumnMapping::fromHeader(const QStringList& header) {
+    ColumnMapping mapping;
+    for (int i = 0; i < header.size(); ++i) {
+        QString key = CsvReader::headerKey(header.at(i));
+        if (key == "bookcode" || key == "code" || key == "barcode" || key == "accessionnumber"
+            || key == "accessionno") {
+            mapping.bookCode = i;
+        } else if (key == "isbn" || key == "isbn13" || key == "isbn10") {
+            mapping.isbn = i;
+        } else if (key == "title" || key == "booktitle") {
+            mapping.title = i;
+        } else if (key == "author" || key == "authors") {
+            mapping.author = i;
+        } else if (key == "subject") {
+            mapping.subject = i;
+        } else if (key == "grade" || key == "gradelevel") {
+            mapping.grade = i;
+        } else if (key == "price" || key == "cost" || key == "replacementcost") {
+            mapping.price = i;
+        }
+    }
+    return mapping;
+}
+
+BookCsvImporter::BookCsvImporter(const Options& options)
+    : m_options(options)
+    , m_tailRows(0)
+    , m_chunkImported(0)
+{
+}
+
+QString BookCsvImporter::normalizeIsbn(const QString& isbn) {
+    QString digits;
+    for (QChar c : isbn) {
+        if (c.isDigit()) {
+            digits += c;
+        } else if (c == 'X' || c == 'x') {
+            digits += 'X';
+        } else if (c != '-' && !c.isSpace()) {
+            return isbn.trimmed();
+        }
+    }
+
+    if (digits.size() == 10 && !digits.left(9).contains('X')) {
+        int sum = 0;
+        for (int i = 0; i < 10; ++i) {
+            int value = digits.at(i) == 'X' ? 10 : digits.at(i).digitValue();
+            sum += (10 - i) * value;
+        }
+        if (sum % 11 != 0) {
+            return isbn.trimmed();
+        }
+
+        QString isbn13 = "978" + digits.left(9);
+        int check = 0;
+        for (int i = 0; i < 12; ++i) {
+            check += isbn13.at(i).digitValue() * (i % 2 ? 3 : 1);
+        }
+        return isbn13 + QString::number((10 - check % 10) % 10);
+    }
+
+    if (digits.size() == 13 && !digits.contains('X')) {
+        int sum = 0;
+        for (int i = 0; i < 13; ++i) {
+            sum += digits.at(i).digitValue() * (i % 2 ? 3 : 1);
+        }
+        if (sum % 10 == 0) {
+            return digits;
+        }
+    }
+
+    return isbn.trimmed();
+}
+
+BookCsvImporter::Report BookCsvImporter::run(const QString& filePath, const CancelCheck& isCancelled,
+                                             const ProgressCallback& onProgress) {
+    QElapsedTimer timer;
+    timer.start();
+
+    m_report = Report();
+    m_codes.clear();
+    m_rows.clear();
+    m_chunkImported = 0;
+
+    CsvReader reader(filePath, m_options.delimiter);
+    if (!reader.open()) {
+        m_report.error = "Cannot open " + filePath + ": " + reader.errorString();
+        return m_report;
+    }
+
+    QSqlDatabase db = DatabaseManager::instance().getDatabase();
+    m_fullInsert = QSqlQuery(db);
+    m_tailInsert = QSqlQuery(db);
+    m_tailRows = 0;
+
+    QString error;
+    if (!loadExistingCodes(error)) {
+        m_report.error = error;
+        return m_report;
+    }
+
+    QStringList fields;
+    ColumnMapping mapping = m_options.mapping;
+    if (m_options.hasHeader) {
+        if (!reader.readRecord(fields)) {
+            m_report.error = "The file is empty";
+            return m_report;
+        }
+        if (!mapping.isValid()) {
+            mapping = ColumnMapping::fromHeader(fields);
+        }
+    }
+    if (!mapping.isValid()) {
+        m_report.error = "The file needs at least a book code and a title column";
+        return m_report;
+    }
+
+    const int rowsPerInsert = qBound(1, m_options.rowsPerInsert, kMaxBoundValues / kColumnsPerRow);
+    const int rowsPerTransaction = qMax(rowsPerInsert, m_options.rowsPerTransaction);
+
+    auto field = [&fields](int column) {
+        return column >= 0 && column < fields.size() ? fields.at(column).trimmed() : QString();
+    };
+    auto reportProgress = [&]() {
+        if (onProgress) {
+            Progress progress;
+            progress.bytesRead = reader.bytesRead();
+            progress.totalBytes = reader.totalBytes();
+            progress.rowsRead = m_report.rowsRead;
+            progress.rowsImported = m_report.rowsImported;
+            qint64 elapsed = timer.elapsed();
+            progress.rowsPerSecond = elapsed > 0 ? m_report.rowsRead * 1000.0 / elapsed : 0.0;
+            onProgress(progress);
+        }
+    };
+    // Commits the open chunk; the statistics must not recount between the
+    // commit and its report
+    auto commitChunk = [&]() {
+        LibraryStatistics::PendingChange pendingChange;
+        if (!db.commit()) {
+            return false;
+        }
+        m_report.rowsImported += m_chunkImported;
+        LibraryStatistics::instance().booksAdded(Book::Status::Available, int(m_chunkImported));
+        m_chunkImported = 0;
+        return true;
+    };
+
+    if (!db.transaction()) {
+        m_report.error = "Failed to start database transaction: " + db.lastError().text();
+        return m_report;
+    }
+
+    int rowsInChunk = 0;
+    while (reader.readRecord(fields)) {
+        ++m_report.rowsRead;
+
+        QString code = field(mapping.bookCode);
+        QString title = field(mapping.title);
+        bool priceOk = false;
+        double price = parsePrice(field(mapping.price), &priceOk);
+
+        if (code.isEmpty() || title.isEmpty()) {
+            ++m_report.invalid;
+            addProblem(reader.lineNumber(), "Missing book code or title");
+        } else if (!priceOk) {
+            ++m_report.invalid;
+            addProblem(reader.lineNumber(), "Invalid price \"" + field(mapping.price) + "\"");
+        } else if (m_codes.contains(code)) {
+            ++m_report.duplicates;
+            addProblem(reader.lineNumber(), "Duplicate book code " + code);
+        } else {
+            m_codes.insert(code);
+            m_rows << code << normalizeIsbn(field(mapping.isbn)) << title << field(mapping.author)
+                   << field(mapping.subject) << field(mapping.grade) << price;
+            ++rowsInChunk;
+
+            if (m_rows.size() == rowsPerInsert * kColumnsPerRow && !flushRows(error)) {
+                break;
+            }
+        }
+
+        if (rowsInChunk >= rowsPerTransaction) {
+            if (!flushRows(error)) {
+                break;
+            }
+            if (!commitChunk()) {
+                error = "Failed to commit: " + db.lastError().text();
+                break;
+            }
+            rowsInChunk = 0;
+            if (!db.transaction()) {
+                error = "Failed to start database transaction: " + db.lastError().text();
+                m_report.error = error;
+                m_report.elapsedMs = timer.elapsed();
+                return m_report;
+            }
+        }
+
+        if (m_report.rowsRead % 1000 == 0) {
+            if (isCancelled && isCancelled()) {
+                m_report.cancelled = true;
+                break;
+            }
+            reportProgress();
+        }
+    }
+
+    if (error.isEmpty() && !m_report.cancelled && flushRows(error)) {
+        if (!commitChunk()) {
+            error = "Failed to commit: " + db.lastError().text();
+        }
+    }
+    if (!error.isEmpty() || m_report.cancelled) {
+        // Only the open chunk is lost; earlier chunks are already committed
+        m_fullInsert.finish();
+        m_tailInsert.finish();
+        db.rollback();
+    }
+    m_chunkImported = 0;
+    m_rows.clear();
+
+    // A profile without automatic checkpoints leaves the import in the WAL
+    if (DatabaseManager::instance().getStorageProfile().walAutoCheckpointPages <= 0) {
+        DatabaseManager::instance().checkpoint(StorageProfile::Checkpoint::Passive);
+    }
+
+    m_report.error = error;
+    m_report.elapsedMs = timer.elapsed();
+    reportProgress();
+    return m_report;
+}
+
+bool BookCsvImporter::loadExistingCodes(QString& error) {
+    QSqlQuery query(DatabaseManager::instance().getDatabase());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT book_code FROM books")) {
+        error = "Failed to read existing book codes: " + query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        m_codes.insert(query.value(0).toString());
+    }
+    return true;
+}
+
+bool BookCsvImporter::flushRows(QString& error) {
+    if (m_rows.isEmpty()) {
+        return true;
+    }
+
+    const int rows = m_rows.size() / kColumnsPerRow;
+    QSqlQuery* query = insertStatement(rows);
+    if (!query) {
+        error = "Failed to prepare the book insert statement";
+        return false;
+    }
+
+    for (int i = 0; i < m_rows.size(); ++i) {
+        query->bindValue(i, m_rows.at(i));
+    }
+    if (!query->exec()) {
+        error = "Failed to insert books: " + query->lastError().text();
+        return false;
+    }
+
+    int inserted = query->numRowsAffected();
+    m_chunkImported += inserted;
+    m_report.duplicates += rows - inserted;
+    m_rows.clear();
+    return true;
+}
+
+// The full-size statement is prepared once; the shorter one only for the
+// final rows of a chunk or file
+QSqlQuery* BookCsvImporter::insertStatement(int rows) {
+    const int fullRows = qBound(1, m_options.rowsPerInsert, kMaxBoundValues / kColumnsPerRow);
+    if (rows == fullRows) {
+        if (m_fullInsert.lastQuery().isEmpty() && !m_fullInsert.prepare(insertSql(rows))) {
+            return nullptr;
+        }
+        return &m_fullInsert;
+    }
+    if (rows != m_tailRows) {
+        m_tailRows = 0;
+        if (!m_tailInsert.prepare(insertSql(rows))) {
+            return nullptr;
+        }
+        m_tailRows = rows;
+    }
+    return &m_tailInsert;
+}
+
+void BookCsvImporter::addProblem(int line, const QString& message) {
+    if (m_report.problems.size() < kMaxProblems) {
+        m_report.problems << QString("Line %1: %2").arg(line).arg(message);
+    }
+}
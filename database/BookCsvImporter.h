@@ -0,0 +1,94 @@
+#ifndef BOOKCSVIMPORTER_H
+#define BOOKCSVIMPORTER_H
+
+#include <QSet>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <functional>
+
+// Streams a catalogue CSV into the books table on the calling thread's
+// connection. Rows are read one at a time, checked against an in-memory set
+// of known book codes and written with multi-row INSERTs in chunked
+// transactions. Cancelling keeps the chunks already committed.
+class BookCsvImporter {
+public:
+    // Zero-based CSV column of each book field, -1 if the file lacks it
+    struct ColumnMapping {
+        int bookCode = -1;
+        int isbn = -1;
+        int title = -1;
+        int author = -1;
+        int subject = -1;
+        int grade = -1;
+        int price = -1;
+
+        // Recognises headers such as "Book Code", "book_code", "ISBN", "Title"
+        static ColumnMapping fromHeader(const QStringList& header);
+        bool isValid() const { return bookCode >= 0 && title >= 0; }
+    };
+
+    struct Options {
+        ColumnMapping mapping;    // Left invalid, it is taken from the header row
+        bool hasHeader = true;
+        QChar delimiter = ',';
+        int rowsPerInsert = 100;
+        int rowsPerTransaction = 5000;
+    };
+
+    struct Progress {
+        qint64 bytesRead = 0;
+        qint64 totalBytes = 0;
+        qint64 rowsRead = 0;
+        qint64 rowsImported = 0;
+        double rowsPerSecond = 0.0;
+    };
+
+    struct Report {
+        qint64 rowsRead = 0;
+        qint64 rowsImported = 0;
+        qint64 duplicates = 0;
+        qint64 invalid = 0;
+        qint64 elapsedMs = 0;
+        bool cancelled = false;
+        QString error;
+        QStringList problems;    // First few rejected rows, with line numbers
+
+        double rowsPerSecond() const {
+            return elapsedMs > 0 ? rowsRead * 1000.0 / elapsedMs : 0.0;
+        }
+    };
+
+    using CancelCheck = std::function<bool()>;
+    using ProgressCallback = std::function<void(const Progress&)>;
+
+    explicit BookCsvImporter(const Options& options = Options());
+
+    Report run(const QString& filePath, const CancelCheck& isCancelled = CancelCheck(),
+               const ProgressCallback& onProgress = ProgressCallback());
+
+    // Digits only (plus a final X for ISBN-10); a valid ISBN-10 becomes ISBN-13.
+    // Text that is not an ISBN is returned trimmed but otherwise unchanged.
+    static QString normalizeIsbn(const QString& isbn);
+
+private:
+    static constexpr int kColumnsPerRow = 7;
+    static constexpr int kMaxProblems = 100;
+
+    bool loadExistingCodes(QString& error);
+    bool flushRows(QString& error);
+    QSqlQuery* insertStatement(int rows);
+    void addProblem(int line, const QString& message);
+
+    Options m_options;
+    Report m_report;
+    QSet<QString> m_codes;
+    QVariantList m_rows;    // Bound values of rows waiting for the next INSERT
+    QSqlQuery m_fullInsert;
+    QSqlQuery m_tailInsert;
+    int m_tailRows;
+    qint64 m_chunkImported;
+};
+
+#endif // BOOKCSVIMPORTER_H
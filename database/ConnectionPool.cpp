@@ -0,0 +1,180 @@
+#include "ConnectionPool.h"
+#include <QSqlError>
+#include <QThread>
+#include <QDebug>
+
+ConnectionPool::Context::Context()
+    : statements(nullptr)
+    , generation(-1)
+    , openCount(nullptr)
+{
+}
+
+ConnectionPool::Context::~Context() {
+    close();
+}
+
+void ConnectionPool::Context::close() {
+    // Cached statements must be released before the connection closes
+    delete statements;
+    statements = nullptr;
+
+    if (database.isOpen()) {
+        database.close();
+        if (openCount) {
+            openCount->fetchAndSubOrdered(1);
+        }
+    }
+
+    // removeDatabase() requires that no QSqlDatabase handle is still alive
+    database = QSqlDatabase();
+    if (!connectionName.isEmpty()) {
+        QSqlDatabase::removeDatabase(connectionName);
+        connectionName.clear();
+    }
+}
+
+ConnectionPool::ConnectionPool()
+    : m_generation(0)
+    , m_nextId(0)
+    , m_openCount(0)
+{
+}
+
+ConnectionPool::~ConnectionPool() {
+    releaseThreadConnection();
+}
+
+void ConnectionPool::configure(const QString& dbPath, ConnectionSetup setup) {
+    QMutexLocker locker(&m_mutex);
+    m_dbPath = dbPath;
+    m_setup = setup;
+    ++m_generation;
+}
+
+bool ConnectionPool::isConfigured() const {
+    QMutexLocker locker(&m_mutex);
+    return !m_dbPath.isEmpty();
+}
+
+QString ConnectionPool::databasePath() const {
+    QMutexLocker locker(&m_mutex);
+    return m_dbPath;
+}
+
+ConnectionPool::Context* ConnectionPool::context() {
+    if (!m_contexts.hasLocalData()) {
+        Context* ctx = new Context();
+        ctx->openCount = &m_openCount;
+        m_contexts.setLocalData(ctx);
+    }
+
+    Context* ctx = m_contexts.localData();
+
+    int generation;
+    {
+        QMutexLocker locker(&m_mutex);
+        generation = m_generation;
+    }
+
+    if (ctx->generation != generation || !ctx->database.isOpen()) {
+        ctx->close();
+        ctx->generation = generation;
+        open(ctx);
+    }
+
+    return ctx;
+}
+
+bool ConnectionPool::open(Context* ctx) {
+    QString dbPath;
+    ConnectionSetup setup;
+    {
+        QMutexLocker locker(&m_mutex);
+        dbPath = m_dbPath;
+        setup = m_setup;
+    }
+
+    if (dbPath.isEmpty()) {
+        ctx->lastError = "Database has not been initialized";
+        return false;
+    }
+
+    ctx->connectionName = QString("lms_connection_%1").arg(m_nextId.fetchAndAddOrdered(1));
+    ctx->database = QSqlDatabase::addDatabase("QSQLITE", ctx->connectionName);
+    ctx->database.setDatabaseName(dbPath);
+
+    if (!ctx->database.open()) {
+        ctx->lastError = "Failed to open database: " + ctx->database.lastError().text();
+        qWarning() << "ConnectionPool:" << ctx->lastError;
+        return false;
+    }
+    m_openCount.fetchAndAddOrdered(1);
+
+    // A connection without its PRAGMAs and archive would fail later and
+    // less clearly, so a failed setup fails the open
+    QString error;
+    if (setup && !setup(ctx->database, error)) {
+        ctx->lastError = "Failed to set up database connection: " + error;
+        qWarning() << "ConnectionPool:" << ctx->lastError;
+        ctx->close();
+        return false;
+    }
+
+    ctx->statements = new StatementCache(ctx->database);
+    return true;
+}
+
+QSqlDatabase ConnectionPool::database() {
+    return context()->database;
+}
+
+StatementCache* ConnectionPool::statements() {
+    Context* ctx = context();
+    if (!ctx->statements) {
+        // Open failed; hand out a cache whose statements fail with a clear error
+        ctx->statements = new StatementCache(ctx->database);
+    }
+    return ctx->statements;
+}
+
+QString ConnectionPool::lastError() const {
+    return m_contexts.hasLocalData() ? m_contexts.localData()->lastError : QString();
+}
+
+void ConnectionPool::setLastError(const QString& error) {
+    if (!m_contexts.hasLocalData()) {
+        Context* ctx = new Context();
+        ctx->openCount = &m_openCount;
+        m_contexts.setLocalData(ctx);
+    }
+    m_contexts.localData()->lastError = error;
+}
+
+void ConnectionPool::releaseThreadConnection() {
+    if (m_contexts.hasLocalData()) {
+        // Keep the thread's last error around for getLastError()
+        m_contexts.localData()->close();
+    }
+}
+
+void ConnectionPool::close() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_dbPath.clear();
+        m_setup = nullptr;
+        ++m_generation;
+    }
+    releaseThreadConnection();
+}
+
+int ConnectionPool::openConnectionCount() const {
+    return m_openCount.loadAcquire();
+}
+
+StatementCache::Stats ConnectionPool::statementStats() const {
+    if (!m_contexts.hasLocalData() || !m_contexts.localData()->statements) {
+        return StatementCache::Stats();
+    }
+    return m_contexts.localData()->statements->stats();
+}
@@ -0,0 +1,74 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QThreadStorage>
+#include <functional>
+#include "StatementCache.h"
+
+// Hands every thread its own named QSQLITE connection to the same database
+// file. QtSql connections must only be used from the thread that created
+// them, so each thread lazily opens one on first use and it is closed and
+// removed again when the thread exits.
+class ConnectionPool {
+public:
+    // Runs once on every freshly opened connection (PRAGMAs etc.); returning
+    // false closes the connection again and fails the open
+    using ConnectionSetup = std::function<bool(QSqlDatabase& database, QString& error)>;
+
+    ConnectionPool();
+    ~ConnectionPool();
+
+    void configure(const QString& dbPath, ConnectionSetup setup);
+    bool isConfigured() const;
+    QString databasePath() const;
+
+    // Calling thread's connection; opened on first use
+    QSqlDatabase database();
+    StatementCache* statements();
+
+    // Errors are tracked per thread so workers don't overwrite each other
+    QString lastError() const;
+    void setLastError(const QString& error);
+
+    // Closes the calling thread's connection now
+    void releaseThreadConnection();
+
+    // Stops handing out connections; other threads drop theirs on next use
+    void close();
+
+    int openConnectionCount() const;
+    StatementCache::Stats statementStats() const;
+
+private:
+    struct Context {
+        QString connectionName;
+        QSqlDatabase database;
+        StatementCache* statements;
+        QString lastError;
+        int generation;
+        QAtomicInt* openCount;
+
+        Context();
+        ~Context();
+        void close();
+    };
+
+    Context* context();
+    bool open(Context* ctx);
+
+    QThreadStorage<Context*> m_contexts;
+
+    mutable QMutex m_mutex;
+    QString m_dbPath;
+    ConnectionSetup m_setup;
+    int m_generation;
+
+    QAtomicInt m_nextId;
+    QAtomicInt m_openCount;
+};
+
+#endif // CONNECTIONPOOL_H
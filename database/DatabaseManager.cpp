@@ -3,188 +3,571 @@
 #include <QSqlRecord>
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
+#include <QDir>
 #include "utils/Encryption.h"
 #include <QSqlQuery>
 #include <QDateTime>
+#include <QSet>
+#include <QDataStream>
+#include <QRegularExpression>
+#include <algorithm>
 #include "Payments.h"
 #include "PaymentItem.h"
+#include "SchemaMigrator.h"
+#include "ActivityLogger.h"
+#include "LibraryStatistics.h"
+#include "DomainEvents.h"
+#include "RowMapper.h"
+
+namespace {
+
+// Column lists in RowMapper order, so rows can be read by ordinal
+const QString kUserColumns = selectColumns<User>();
+const QString kUserListColumns = selectColumns<UserListRow>();
+const QString kLearnerColumns = selectColumns<Learner>();
+const QString kBookColumns = selectColumns<Book>();
+const QString kBookListColumns = selectColumns<BookListRow>();
+const QString kTransactionColumns = selectColumns<Transaction>();
+const QString kPaymentColumns = selectColumns<Payments>();
+const QString kPaymentItemColumns = selectColumns<PaymentItem>();
+const QString kTransactionDetailColumns = selectColumns<TransactionDetail>();
+
+// LEFT JOINs keep a transaction visible even if its book or learner row is gone
+const QString kTransactionDetailFrom =
+    "transactions t LEFT JOIN books b ON b.id = t.book_id LEFT JOIN learners l ON l.id = t.learner_id";
+
+// transactions_all is the per-connection temp view over the live and archived
+// tables (see attachArchive); filters are pushed into both halves of the union
+QString transactionsTable(DatabaseManager::HistoryScope scope) {
+    return scope == DatabaseManager::HistoryScope::Full ? "transactions_all" : "transactions";
+}
+
+QString transactionDetailFrom(DatabaseManager::HistoryScope scope) {
+    if (scope == DatabaseManager::HistoryScope::Current) {
+        return kTransactionDetailFrom;
+    }
+    return transactionsTable(scope) +
+           " t LEFT JOIN books b ON b.id = t.book_id LEFT JOIN learners l ON l.id = t.learner_id";
+}
+
+// "[3,7,12]" for binding an id list to json_each(); duplicates are dropped
+QString idListJson(const QVector<int>& ids) {
+    QSet<int> seen;
+    QStringList parts;
+    for (int id : ids) {
+        if (!seen.contains(id)) {
+            seen.insert(id);
+            parts << QString::number(id);
+        }
+    }
+    return "[" + parts.join(",") + "]";
+}
+
+// Keyset pagination: "(key..., id) > (:k0..., :last_id)" seeks straight into the
+// index that matches the ORDER BY, so page 500 costs the same as page 1.
+QString keysetSql(const QString& selectList, const QString& table, const QStringList& keyColumns,
+                  bool descending, bool hasCursor, const QString& filter = QString(),
+                  const QString& idColumn = "id") {
+    QStringList columns = keyColumns;
+    columns << idColumn;
+
+    QStringList placeholders;
+    for (int i = 0; i < keyColumns.size(); ++i) {
+        placeholders << QString(":k%1").arg(i);
+    }
+    placeholders << ":last_id";
+
+    QStringList conditions;
+    if (!filter.isEmpty()) {
+        conditions << filter;
+    }
+    if (hasCursor) {
+        conditions << QString("(%1) %2 (%3)")
+                          .arg(columns.join(", "), descending ? "<" : ">", placeholders.join(", "));
+    }
+
+    QStringList order;
+    for (const QString& column : columns) {
+        order << (descending ? column + " DESC" : column);
+    }
+
+    QString sql = "SELECT " + selectList + " FROM " + table;
+    if (!conditions.isEmpty()) {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    sql += " ORDER BY " + order.join(", ") + " LIMIT :limit";
+    return sql;
+}
+
+void bindCursor(QSqlQuery& query, const PageCursor& cursor, int limit) {
+    if (!cursor.isStart()) {
+        for (int i = 0; i < cursor.keys.size(); ++i) {
+            query.bindValue(QString(":k%1").arg(i), cursor.keys.at(i));
+        }
+        query.bindValue(":last_id", cursor.lastId);
+    }
+    // One extra row tells us whether another page follows
+    query.bindValue(":limit", limit + 1);
+}
+
+// Reads up to limit rows of a keyset query; the cursor keeps raw column
+// values so they bind back exactly as stored
+template <typename T>
+Page<T> readPage(QSqlQuery& query, const QStringList& keyColumns, const PageCursor& after, int limit,
+                 const QString& idColumn = "id") {
+    Page<T> page;
+    page.next = after;
+
+    QVector<int> keyOrdinals;
+    for (const QString& column : keyColumns) {
+        keyOrdinals << columnIndex<T>(column);
+    }
+    const int idOrdinal = columnIndex<T>(idColumn);
+
+    while (query.next()) {
+        if (page.items.size() == limit) {
+            page.hasMore = true;
+            break;
+        }
+        page.next.keys.clear();
+        for (int ordinal : keyOrdinals) {
+            page.next.keys << query.value(ordinal);
+        }
+        page.next.lastId = query.value(idOrdinal).toInt();
+        page.items.append(RowMapper<T>::map(query));
+    }
+
+    return page;
+}
+
+// Reads up to limit rows of a query paged by ":limit"/":offset" (bound with
+// limit + 1, like bindCursor). Rows with skipId are consumed but not returned.
+template <typename T>
+Page<T> readOffsetPage(QSqlQuery& query, const PageCursor& after, int limit, int skipId = -1) {
+    Page<T> page;
+    page.next = after;
+
+    const int idOrdinal = columnIndex<T>("id");
+    int read = 0;
+    while (query.next()) {
+        if (read == limit) {
+            page.hasMore = true;
+            break;
+        }
+        ++read;
+        page.next.lastId = query.value(idOrdinal).toInt();
+        if (page.next.lastId != skipId) {
+            page.items.append(RowMapper<T>::map(query));
+        }
+    }
+    page.next.offset = after.offset + read;
+
+    return page;
+}
+
+// Turns free text into an FTS5 query: every word becomes a quoted prefix term,
+// so punctuation typed by the user can never be parsed as FTS syntax.
+QString ftsMatchExpression(const QString& searchTerm, int* longestWord = nullptr) {
+    QStringList terms;
+    int longest = 0;
+    const QStringList words = searchTerm.simplified().split(' ', Qt::SkipEmptyParts);
+    for (QString word : words) {
+        longest = qMax(longest, word.size());
+        word.replace('"', "\"\"");
+        terms << "\"" + word + "\"*";
+    }
+    if (longestWord) {
+        *longestWord = longest;
+    }
+    return terms.join(' ');
+}
+
+// Ranking one- and two-letter prefixes means scoring most of the table;
+// below this length results come back unranked in index order instead.
+const int kMinRankedWordLength = 3;
+
+// Search statements shared by the capped and the paged searches. %1 is the
+// select list over alias b (books) or l (learners). Ties are broken by id so
+// an offset lands on the same row every time the page is read.
+QString bookSearchSql(bool useFts, int longestWord) {
+    if (!useFts) {
+        return R"(
+            SELECT %1 FROM books b
+            WHERE b.title LIKE :search OR b.author LIKE :search OR
+                  b.book_code LIKE :search OR b.isbn LIKE :search
+            ORDER BY b.title, b.id
+            LIMIT :limit OFFSET :offset
+        )";
+    }
+    if (longestWord >= kMinRankedWordLength) {
+        // Title matches weigh most, then author, then code/ISBN
+        return R"(
+            SELECT %1 FROM books_fts
+            JOIN books b ON b.id = books_fts.rowid
+            WHERE books_fts MATCH :match
+            ORDER BY bm25(books_fts, 10.0, 5.0, 2.0, 2.0), b.title, b.id
+            LIMIT :limit OFFSET :offset
+        )";
+    }
+    return R"(
+        SELECT %1 FROM books_fts
+        JOIN books b ON b.id = books_fts.rowid
+        WHERE books_fts MATCH :match
+        ORDER BY books_fts.rowid
+        LIMIT :limit OFFSET :offset
+    )";
+}
+
+QString learnerSearchSql(bool useFts, int longestWord) {
+    if (!useFts) {
+        return R"(
+            SELECT %1 FROM learners l
+            WHERE l.name LIKE :search OR l.surname LIKE :search OR
+                  CAST(l.id AS TEXT) LIKE :search
+            ORDER BY l.surname, l.name, l.id
+            LIMIT :limit OFFSET :offset
+        )";
+    }
+    if (longestWord >= kMinRankedWordLength) {
+        // Surname matches weigh more than first names
+        return R"(
+            SELECT %1 FROM learners_fts
+            JOIN learners l ON l.id = learners_fts.rowid
+            WHERE learners_fts MATCH :match
+            ORDER BY bm25(learners_fts, 5.0, 10.0), l.surname, l.name, l.id
+            LIMIT :limit OFFSET :offset
+        )";
+    }
+    return R"(
+        SELECT %1 FROM learners_fts
+        JOIN learners l ON l.id = learners_fts.rowid
+        WHERE learners_fts MATCH :match
+        ORDER BY learners_fts.rowid
+        LIMIT :limit OFFSET :offset
+    )";
+}
+
+QStringList bookSortColumns(DatabaseManager::BookSort sort) {
+    switch (sort) {
+        case DatabaseManager::BookSort::Author: return {"author"};
+        case DatabaseManager::BookSort::GradeTitle: return {"grade", "title"};
+        case DatabaseManager::BookSort::SubjectTitle: return {"subject", "title"};
+        case DatabaseManager::BookSort::Title:
+        default: return {"title"};
+    }
+}
+
+QStringList learnerSortColumns(DatabaseManager::LearnerSort sort) {
+    switch (sort) {
+        case DatabaseManager::LearnerSort::GradeSurname: return {"grade", "surname", "name"};
+        case DatabaseManager::LearnerSort::Surname:
+        default: return {"surname", "name"};
+    }
+}
+
+
+// Closed months of the activity log live in user_activity_logs_yyyyMM tables;
+// the name is built from a validated period, never from user input
+QString activityPartitionTable(const QString& period) {
+    static const QRegularExpression pattern("^(\\d{4})-(\\d{2})$");
+    QRegularExpressionMatch match = pattern.match(period);
+    return match.hasMatch() ? "user_activity_logs_" + match.captured(1) + match.captured(2) : QString();
+}
+
+// Compressed months keep their rows in created_at order as one qCompress()ed stream
+QByteArray packActivityRows(const QVector<UserActivityLog>& rows) {
+    QByteArray raw;
+    QDataStream out(&raw, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << qint32(rows.size());
+    for (const UserActivityLog& row : rows) {
+        out << qint32(row.id) << qint32(row.userId) << row.actionType << row.actionDetails << row.createdAt;
+    }
+    return qCompress(raw, 9);
+}
+
+QVector<UserActivityLog> unpackActivityRows(const QByteArray& packed) {
+    QVector<UserActivityLog> rows;
+    QByteArray raw = qUncompress(packed);
+    QDataStream in(raw);
+    in.setVersion(QDataStream::Qt_6_0);
+    qint32 count = 0;
+    in >> count;
+    rows.reserve(qMax(0, count));
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        qint32 id = 0;
+        qint32 userId = 0;
+        UserActivityLog row;
+        in >> id >> userId >> row.actionType >> row.actionDetails >> row.createdAt;
+        row.id = id;
+        row.userId = userId;
+        rows.append(row);
+    }
+    return rows;
+}
+
+// Called only after the change has committed
+void publish(DomainEvent::Type type, int bookId, int learnerId, int transactionId = -1, int paymentId = -1) {
+    DomainEvent event;
+    event.type = type;
+    event.bookId = bookId;
+    event.learnerId = learnerId;
+    event.transactionId = transactionId;
+    event.paymentId = paymentId;
+    DomainEvents::instance().publish(event);
+}
+
+} // namespace
 
 DatabaseManager& DatabaseManager::instance() {
     static DatabaseManager instance;
     return instance;
 }
 
-DatabaseManager::DatabaseManager() {
+DatabaseManager::DatabaseManager()
+    : m_storageProfile(StorageProfile::deskLaptop())
+    , m_fullTextSearch(-1)
+    , m_bookCache(kDefaultEntityCacheCapacity)
+    , m_learnerCache(kDefaultEntityCacheCapacity)
+    , m_userCache(kDefaultEntityCacheCapacity)
+{
 }
 
 DatabaseManager::~DatabaseManager() {
     closeDatabase();
 }
 
-bool DatabaseManager::initialize(const QString& dbPath) {
-    m_database = QSqlDatabase::addDatabase("QSQLITE");
-    m_database.setDatabaseName(dbPath);
-    
-    if (!m_database.open()) {
-        setLastError("Failed to open database: " + m_database.lastError().text());
-        return false;
+bool DatabaseManager::initialize(const QString& dbPath, const StorageProfile& profile) {
+    {
+        QMutexLocker locker(&m_profileMutex);
+        m_storageProfile = profile;
     }
-    // Delete old tables and recreate them (only run this once!)
-    QSqlQuery cleanupQuery;
-    cleanupQuery.exec("DROP TABLE IF EXISTS payment_items");
-    cleanupQuery.exec("DROP TABLE IF EXISTS payments");
-
-    // Then recreate them
-    DatabaseManager::instance().createPaymentTables();
-    
-    return createTables();
-}
-
-bool DatabaseManager::createTables() {
-    QSqlQuery query(m_database);
-    
-    // Create Users table
-    QString createUsersTable = R"(
-        CREATE TABLE IF NOT EXISTS users (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            username TEXT UNIQUE NOT NULL,
-            password_hash TEXT NOT NULL,
-            name TEXT NOT NULL,
-            surname TEXT NOT NULL,
-            email TEXT UNIQUE NOT NULL,
-            contact_no TEXT,
-            school_name TEXT,
-            role TEXT NOT NULL,
-            security_question TEXT NOT NULL,
-            security_answer TEXT NOT NULL,
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP
-        )
-    )";
-    
-    if (!query.exec(createUsersTable)) {
-        setLastError("Failed to create users table: " + query.lastError().text());
+
+    // Every thread's connection is opened and configured the same way
+    m_pool.configure(dbPath, [this](QSqlDatabase& database, QString& error) {
+        return configureConnection(database, error);
+    });
+
+    // A failed open or connection setup leaves no open connection; the pool
+    // has already recorded the reason for this thread
+    if (!database().isOpen()) {
         return false;
     }
+
+    m_fullTextSearch.storeRelease(-1);
+    clearEntityCaches();
     
-    // Create Learners table
-    QString createLearnersTable = R"(
-        CREATE TABLE IF NOT EXISTS learners (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            name TEXT NOT NULL,
-            surname TEXT NOT NULL,
-            grade TEXT NOT NULL,
-            date_of_birth DATE NOT NULL,
-            contact_no TEXT,
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP
-        )
-    )";
-    
-    if (!query.exec(createLearnersTable)) {
-        setLastError("Failed to create learners table: " + query.lastError().text());
+    return migrateSchema();
+}
+
+bool DatabaseManager::migrateSchema() {
+    SchemaMigrator migrator(database());
+    if (!migrator.migrate()) {
+        setLastError(migrator.getLastError());
         return false;
     }
-    
-    // Create Books table
-    QString createBooksTable = R"(
-        CREATE TABLE IF NOT EXISTS books (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            book_code TEXT UNIQUE NOT NULL,
-            isbn TEXT NOT NULL,
-            title TEXT NOT NULL,
-            author TEXT NOT NULL,
-            subject TEXT NOT NULL,
-            grade TEXT NOT NULL,
-            price REAL NOT NULL DEFAULT 0.0,
-            status TEXT NOT NULL DEFAULT 'Available',
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP
-        )
-    )";
-    
-    if (!query.exec(createBooksTable)) {
-        setLastError("Failed to create books table: " + query.lastError().text());
-        return false;
+    return true;
+}
+
+void DatabaseManager::closeDatabase() {
+    if (!m_pool.isConfigured()) {
+        return;
     }
-    
-    // Create Transactions table
-    QString createTransactionsTable = R"(
-        CREATE TABLE IF NOT EXISTS transactions (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            learner_id INTEGER NOT NULL,
-            book_id INTEGER NOT NULL,
-            borrow_date DATE NOT NULL,
-            due_date DATE NOT NULL,
-            return_date DATE,
-            status TEXT NOT NULL DEFAULT 'Active',
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-            FOREIGN KEY (learner_id) REFERENCES learners(id),
-            FOREIGN KEY (book_id) REFERENCES books(id)
-        )
-    )";
-    
-    if (!query.exec(createTransactionsTable)) {
-        setLastError("Failed to create transactions table: " + query.lastError().text());
-        return false;
+
+    // Fold the WAL back into the main file so a copied .db is complete
+    if (getStorageProfile().walJournal && database().isOpen()) {
+        checkpoint(StorageProfile::Checkpoint::Truncate);
     }
+    m_pool.close();
+    clearEntityCaches();
+}
 
-    // Create user_activity_logs table
-    QString createActivityLogTable = R"(
-        CREATE TABLE IF NOT EXISTS user_activity_logs (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            user_id INTEGER NOT NULL,
-            action_type TEXT NOT NULL,
-            action_details TEXT,
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-            FOREIGN KEY (user_id) REFERENCES users(id)
-        )
-    )";
+QSqlDatabase DatabaseManager::database() {
+    return m_pool.database();
+}
 
-    if (!query.exec(createActivityLogTable)) {
-        qCritical() << "Failed to create user_activity_logs table:" << query.lastError().text();
+bool DatabaseManager::hasFullTextSearch() {
+    int state = m_fullTextSearch.loadAcquire();
+    if (state < 0) {
+        // Migration 4 skips the FTS tables when SQLite is built without FTS5
+        auto query = statement(R"(
+            SELECT COUNT(*) FROM sqlite_master
+            WHERE type = 'table' AND name IN ('books_fts', 'learners_fts')
+        )");
+        state = (executeQuery(*query) && query->next() && query->value(0).toInt() == 2) ? 1 : 0;
+        m_fullTextSearch.storeRelease(state);
+    }
+    return state == 1;
+}
+
+StorageProfile DatabaseManager::getStorageProfile() const {
+    QMutexLocker locker(&m_profileMutex);
+    return m_storageProfile;
+}
+
+bool DatabaseManager::configureConnection(QSqlDatabase& database, QString& error) {
+    QSqlQuery query(database);
+
+    // Foreign key enforcement is per connection and must be set outside a transaction
+    query.exec("PRAGMA foreign_keys = ON");
+
+    StorageProfile profile = getStorageProfile();
+    if (!applyStorageProfile(database, profile, error)) {
         return false;
     }
 
-    // Add password_changed_at and last_login columns to users table if they don't exist
-    query.exec("ALTER TABLE users ADD COLUMN password_changed_at DATETIME");
-    query.exec("ALTER TABLE users ADD COLUMN last_login DATETIME");
+    attachArchive(database, profile);
+    return true;
+}
 
-    
+// ATTACH is per connection, so every pooled connection attaches the archive and
+// defines its own transactions_all view. An archive that can't be opened only
+// costs full history: the view then covers the live table alone.
+void DatabaseManager::attachArchive(QSqlDatabase& database, const StorageProfile& profile) {
+    QSqlQuery query(database);
+    bool attached = false;
+
+    query.prepare("ATTACH DATABASE :path AS archive");
+    query.bindValue(":path", archivePathFor(database.databaseName()));
+    if (query.exec()) {
+        attached = true;
+        // No foreign keys: SQLite can't enforce them across database files
+        const QStringList statements = {
+            "PRAGMA archive.journal_mode = " + QString(profile.walJournal ? "WAL" : "DELETE"),
+            "PRAGMA archive.synchronous = " + StorageProfile::synchronousToString(profile.synchronous),
+            R"(
+                CREATE TABLE IF NOT EXISTS archive.transactions (
+                    id INTEGER PRIMARY KEY,
+                    learner_id INTEGER NOT NULL,
+                    book_id INTEGER NOT NULL,
+                    borrow_date DATE NOT NULL,
+                    due_date DATE NOT NULL,
+                    return_date DATE,
+                    status TEXT NOT NULL,
+                    created_at DATETIME,
+                    archived_at DATETIME DEFAULT CURRENT_TIMESTAMP
+                )
+            )",
+            "CREATE INDEX IF NOT EXISTS archive.idx_archive_transactions_learner_created "
+            "ON transactions(learner_id, created_at)",
+            "CREATE INDEX IF NOT EXISTS archive.idx_archive_transactions_book ON transactions(book_id)",
+            "CREATE INDEX IF NOT EXISTS archive.idx_archive_transactions_created_at ON transactions(created_at)",
+            "CREATE INDEX IF NOT EXISTS archive.idx_archive_transactions_borrow_date ON transactions(borrow_date)"
+        };
+        for (const QString& sql : statements) {
+            if (!query.exec(sql)) {
+                qWarning() << "Transaction archive unavailable:" << query.lastError().text();
+                query.finish();
+                query.exec("DETACH DATABASE archive");
+                attached = false;
+                break;
+            }
+        }
+    } else {
+        qWarning() << "Could not attach the transaction archive:" << query.lastError().text();
+    }
+    query.finish();
+
+    QString view = "CREATE TEMP VIEW IF NOT EXISTS transactions_all AS SELECT " + kTransactionColumns +
+                   " FROM main.transactions";
+    if (attached) {
+        view += " UNION ALL SELECT " + kTransactionColumns + " FROM archive.transactions";
+    }
+    if (!query.exec(view)) {
+        qWarning() << "Failed to create transactions_all:" << query.lastError().text();
+    }
+}
+
+bool DatabaseManager::applyStorageProfile(QSqlDatabase& database, const StorageProfile& profile,
+                                          QString& error) {
+    QSqlQuery query(database);
+
+    // page_size only sticks before the first table exists and before WAL is enabled
+    query.exec(QString("PRAGMA page_size = %1").arg(profile.pageSize));
+
+    QString journalMode = profile.walJournal ? "WAL" : "DELETE";
+    if (!query.exec("PRAGMA journal_mode = " + journalMode) || !query.next()) {
+        error = "Failed to set journal mode: " + query.lastError().text();
+        return false;
+    }
+    if (query.value(0).toString().compare(journalMode, Qt::CaseInsensitive) != 0) {
+        // e.g. WAL is unavailable on some network filesystems; keep running in the old mode
+        qWarning() << "Requested journal mode" << journalMode
+                   << "but SQLite kept" << query.value(0).toString();
+    }
+    query.finish();
+
+    QStringList pragmas = {
+        "PRAGMA synchronous = " + StorageProfile::synchronousToString(profile.synchronous),
+        QString("PRAGMA cache_size = %1").arg(-profile.cacheSizeKiB),
+        QString("PRAGMA mmap_size = %1").arg(profile.mmapSizeBytes),
+        QString("PRAGMA temp_store = %1").arg(profile.tempStoreInMemory ? "MEMORY" : "DEFAULT"),
+        QString("PRAGMA wal_autocheckpoint = %1").arg(profile.walAutoCheckpointPages),
+        QString("PRAGMA busy_timeout = %1").arg(profile.busyTimeoutMs)
+    };
+
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            error = "Failed to apply storage profile (" + pragma + "): " + query.lastError().text();
+            return false;
+        }
+    }
+
+    qDebug() << "Storage profile applied:" << profile.name << "on" << database.connectionName();
     return true;
 }
 
-void DatabaseManager::closeDatabase() {
-    if (m_database.isOpen()) {
-        m_database.close();
+bool DatabaseManager::checkpoint(StorageProfile::Checkpoint mode) {
+    QSqlQuery query(database());
+    QString sql = "PRAGMA wal_checkpoint(" + StorageProfile::checkpointToString(mode) + ")";
+
+    if (!query.exec(sql) || !query.next()) {
+        setLastError("Checkpoint failed: " + query.lastError().text());
+        return false;
     }
+
+    // Columns: busy flag, frames in the WAL, frames copied back to the database
+    bool busy = query.value(0).toInt() != 0;
+    if (busy) {
+        qDebug() << "Checkpoint" << StorageProfile::checkpointToString(mode)
+                 << "could not complete; log frames:" << query.value(1).toInt()
+                 << "checkpointed:" << query.value(2).toInt();
+    }
+    return !busy;
 }
 
 // ==================== User Operations ====================
 
 bool DatabaseManager::addUser(const User& user) {
-    QSqlQuery query(m_database);
-    query.prepare(R"(
+    LibraryStatistics::PendingChange pendingChange;
+    auto query = statement(R"(
         INSERT INTO users (username, password_hash, name, surname, email, 
                           contact_no, school_name, role, security_question, security_answer)
         VALUES (:username, :password_hash, :name, :surname, :email,
                 :contact_no, :school_name, :role, :security_question, :security_answer)
     )");
     
-    query.bindValue(":username", user.getUsername());
-    query.bindValue(":password_hash", user.getPasswordHash());
-    query.bindValue(":name", user.getName());
-    query.bindValue(":surname", user.getSurname());
-    query.bindValue(":email", user.getEmail());
-    query.bindValue(":contact_no", user.getContactNo());
-    query.bindValue(":school_name", user.getSchoolName());
-    query.bindValue(":role", User::roleToString(user.getRole()));
-    query.bindValue(":security_question", user.getSecurityQuestion());
-    query.bindValue(":security_answer", user.getSecurityAnswer());
-    
-    return executeQuery(query);
+    query->bindValue(":username", user.getUsername());
+    query->bindValue(":password_hash", user.getPasswordHash());
+    query->bindValue(":name", user.getName());
+    query->bindValue(":surname", user.getSurname());
+    query->bindValue(":email", user.getEmail());
+    query->bindValue(":contact_no", user.getContactNo());
+    query->bindValue(":school_name", user.getSchoolName());
+    query->bindValue(":role", User::roleToString(user.getRole()));
+    query->bindValue(":security_question", user.getSecurityQuestion());
+    query->bindValue(":security_answer", user.getSecurityAnswer());
+    
+    if (!executeQuery(*query)) {
+        return false;
+    }
+    LibraryStatistics::instance().usersChanged(1);
+    return true;
 }
 
 bool DatabaseManager::updateUser(const User& user) {
-    QSqlQuery query(m_database);
-    query.prepare(R"(
+    auto query = statement(R"(
         UPDATE users SET username = :username, password_hash = :password_hash,
                         name = :name, surname = :surname, email = :email,
                         contact_no = :contact_no, school_name = :school_name,
@@ -193,98 +576,71 @@ bool DatabaseManager::updateUser(const User& user) {
         WHERE id = :id
     )");
     
-    query.bindValue(":id", user.getId());
-    query.bindValue(":username", user.getUsername());
-    query.bindValue(":password_hash", user.getPasswordHash());
-    query.bindValue(":name", user.getName());
-    query.bindValue(":surname", user.getSurname());
-    query.bindValue(":email", user.getEmail());
-    query.bindValue(":contact_no", user.getContactNo());
-    query.bindValue(":school_name", user.getSchoolName());
-    query.bindValue(":role", User::roleToString(user.getRole()));
-    query.bindValue(":security_question", user.getSecurityQuestion());
-    query.bindValue(":security_answer", user.getSecurityAnswer());
-    
-    return executeQuery(query);
+    query->bindValue(":id", user.getId());
+    query->bindValue(":username", user.getUsername());
+    query->bindValue(":password_hash", user.getPasswordHash());
+    query->bindValue(":name", user.getName());
+    query->bindValue(":surname", user.getSurname());
+    query->bindValue(":email", user.getEmail());
+    query->bindValue(":contact_no", user.getContactNo());
+    query->bindValue(":school_name", user.getSchoolName());
+    query->bindValue(":role", User::roleToString(user.getRole()));
+    query->bindValue(":security_question", user.getSecurityQuestion());
+    query->bindValue(":security_answer", user.getSecurityAnswer());
+    
+    bool ok = executeQuery(*query);
+    m_userCache.remove(user.getId());
+    return ok;
 }
 
 bool DatabaseManager::deleteUser(int userId) {
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM users WHERE id = :id");
-    query.bindValue(":id", userId);
-    return executeQuery(query);
+    LibraryStatistics::PendingChange pendingChange;
+    auto query = statement("DELETE FROM users WHERE id = :id");
+    query->bindValue(":id", userId);
+    bool ok = executeQuery(*query);
+    m_userCache.remove(userId);
+    if (ok) {
+        LibraryStatistics::instance().usersChanged(-query->numRowsAffected());
+    }
+    return ok;
 }
 
 User DatabaseManager::getUserById(int userId) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM users WHERE id = :id");
-    query.bindValue(":id", userId);
-    
-    if (executeQuery(query) && query.next()) {
-        return User(
-            query.value("id").toInt(),
-            query.value("username").toString(),
-            query.value("password_hash").toString(),
-            query.value("name").toString(),
-            query.value("surname").toString(),
-            query.value("email").toString(),
-            query.value("contact_no").toString(),
-            query.value("school_name").toString(),
-            User::stringToRole(query.value("role").toString()),
-            query.value("security_question").toString(),
-            query.value("security_answer").toString(),
-            query.value("created_at").toDateTime()
-        );
+    User user;
+    if (m_userCache.lookup(userId, &user)) {
+        return user;
+    }
+
+    const quint64 generation = m_userCache.generation();
+    auto query = statement("SELECT " + kUserColumns + " FROM users WHERE id = :id");
+    query->bindValue(":id", userId);
+    
+    if (executeQuery(*query) && query->next()) {
+        user = RowMapper<User>::map(*query);
+        m_userCache.insert(userId, user, generation);
+        return user;
     }
     
     return User();
 }
 
 User DatabaseManager::getUserByUsername(const QString& username) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM users WHERE username = :username");
-    query.bindValue(":username", username);
-    
-    if (executeQuery(query) && query.next()) {
-        return User(
-            query.value("id").toInt(),
-            query.value("username").toString(),
-            query.value("password_hash").toString(),
-            query.value("name").toString(),
-            query.value("surname").toString(),
-            query.value("email").toString(),
-            query.value("contact_no").toString(),
-            query.value("school_name").toString(),
-            User::stringToRole(query.value("role").toString()),
-            query.value("security_question").toString(),
-            query.value("security_answer").toString(),
-            query.value("created_at").toDateTime()
-        );
+    auto query = statement("SELECT " + kUserColumns + " FROM users WHERE username = :username");
+    query->bindValue(":username", username);
+    
+    if (executeQuery(*query) && query->next()) {
+        return RowMapper<User>::map(*query);
     }
     
     return User();
 }
 
 User DatabaseManager::getUserByEmail(const QString& email) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM users WHERE email = :email");
-    query.bindValue(":email", email);
-    
-    if (executeQuery(query) && query.next()) {
-        return User(
-            query.value("id").toInt(),
-            query.value("username").toString(),
-            query.value("password_hash").toString(),
-            query.value("name").toString(),
-            query.value("surname").toString(),
-            query.value("email").toString(),
-            query.value("contact_no").toString(),
-            query.value("school_name").toString(),
-            User::stringToRole(query.value("role").toString()),
-            query.value("security_question").toString(),
-            query.value("security_answer").toString(),
-            query.value("created_at").toDateTime()
-        );
+    auto query = statement("SELECT " + kUserColumns + " FROM users WHERE email = :email");
+    query->bindValue(":email", email);
+    
+    if (executeQuery(*query) && query->next()) {
+        return RowMapper<User>::map(*query);
     }
     
     return User();
@@ -292,93 +648,86 @@ User DatabaseManager::getUserByEmail(const QString& email) {
 
 QVector<User> DatabaseManager::getAllUsers() {
     QVector<User> users;
-    QSqlQuery query("SELECT * FROM users ORDER BY name, surname", m_database);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            users.append(User(
-                query.value("id").toInt(),
-                query.value("username").toString(),
-                query.value("password_hash").toString(),
-                query.value("name").toString(),
-                query.value("surname").toString(),
-                query.value("email").toString(),
-                query.value("contact_no").toString(),
-                query.value("school_name").toString(),
-                User::stringToRole(query.value("role").toString()),
-                query.value("security_question").toString(),
-                query.value("security_answer").toString(),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kUserColumns + " FROM users ORDER BY name, surname");
+    
+    if (executeQuery(*query)) {
+        users = mapRows<User>(*query);
     }
     
     return users;
 }
 
-QVector<Transaction> DatabaseManager::getTransactionsByBookId(int bookId) {
+QVector<UserListRow> DatabaseManager::getUserList() {
+    QVector<UserListRow> users;
+    auto query = statement("SELECT " + kUserListColumns + " FROM users ORDER BY name, surname");
+
+    if (executeQuery(*query)) {
+        users = mapRows<UserListRow>(*query);
+    }
+
+    return users;
+}
+
+Page<UserListRow> DatabaseManager::getUsersPage(const PageCursor& after, int limit) {
+    const QStringList keys = {"name", "surname"};
+    auto query = statement(keysetSql(kUserListColumns, "users", keys, false, !after.isStart()));
+    bindCursor(*query, after, limit);
+
+    if (!executeQuery(*query)) {
+        return Page<UserListRow>();
+    }
+    return readPage<UserListRow>(*query, keys, after, limit);
+}
+
+QVector<Transaction> DatabaseManager::getTransactionsByBookId(int bookId, HistoryScope scope) {
     QVector<Transaction> transactions;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM transactions WHERE book_id = :book_id ORDER BY created_at DESC");
-    query.bindValue(":book_id", bookId);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transactions.append(Transaction(
-                query.value("id").toInt(),
-                query.value("learner_id").toInt(),
-                query.value("book_id").toInt(),
-                query.value("borrow_date").toDate(),
-                query.value("due_date").toDate(),
-                query.value("return_date").toDate(),
-                Transaction::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kTransactionColumns + " FROM " + transactionsTable(scope) +
+                           " WHERE book_id = :book_id ORDER BY created_at DESC");
+    query->bindValue(":book_id", bookId);
+    
+    if (executeQuery(*query)) {
+        transactions = mapRows<Transaction>(*query);
     }
     
     return transactions;
 }
 
-QVector<Transaction> DatabaseManager::getAllTransactions() {
+QVector<Transaction> DatabaseManager::getAllTransactions(HistoryScope scope) {
     QVector<Transaction> transactions;
-    QSqlQuery query("SELECT * FROM transactions ORDER BY created_at DESC", m_database);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transactions.append(Transaction(
-                query.value("id").toInt(),
-                query.value("learner_id").toInt(),
-                query.value("book_id").toInt(),
-                query.value("borrow_date").toDate(),
-                query.value("due_date").toDate(),
-                query.value("return_date").toDate(),
-                Transaction::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kTransactionColumns + " FROM " + transactionsTable(scope) +
+                           " ORDER BY created_at DESC");
+    
+    if (executeQuery(*query)) {
+        transactions = mapRows<Transaction>(*query);
     }
     
     return transactions;
 }
 
+Page<Transaction> DatabaseManager::getTransactionsPage(const PageCursor& after, int limit, int learnerId,
+                                                      HistoryScope scope) {
+    // Newest first; a learner filter uses the (learner_id, created_at) index
+    const QStringList keys = {"created_at"};
+    QString filter = learnerId >= 0 ? "learner_id = :learner_id" : QString();
+    auto query = statement(keysetSql(kTransactionColumns, transactionsTable(scope), keys, true,
+                                     !after.isStart(), filter));
+    if (learnerId >= 0) {
+        query->bindValue(":learner_id", learnerId);
+    }
+    bindCursor(*query, after, limit);
+
+    if (!executeQuery(*query)) {
+        return Page<Transaction>();
+    }
+    return readPage<Transaction>(*query, keys, after, limit);
+}
+
 QVector<Transaction> DatabaseManager::getActiveTransactions() {
     QVector<Transaction> transactions;
-    QSqlQuery query("SELECT * FROM transactions WHERE status = 'Active' ORDER BY created_at DESC", m_database);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transactions.append(Transaction(
-                query.value("id").toInt(),
-                query.value("learner_id").toInt(),
-                query.value("book_id").toInt(),
-                query.value("borrow_date").toDate(),
-                query.value("due_date").toDate(),
-                query.value("return_date").toDate(),
-                Transaction::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kTransactionColumns + " FROM transactions WHERE status = 'Active' ORDER BY created_at DESC");
+    
+    if (executeQuery(*query)) {
+        transactions = mapRows<Transaction>(*query);
     }
     
     return transactions;
@@ -386,48 +735,26 @@ QVector<Transaction> DatabaseManager::getActiveTransactions() {
 
 QVector<Transaction> DatabaseManager::getOverdueTransactions() {
     QVector<Transaction> transactions;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM transactions WHERE status = 'Active' AND due_date < :current_date ORDER BY due_date");
-    query.bindValue(":current_date", QDate::currentDate());
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transactions.append(Transaction(
-                query.value("id").toInt(),
-                query.value("learner_id").toInt(),
-                query.value("book_id").toInt(),
-                query.value("borrow_date").toDate(),
-                query.value("due_date").toDate(),
-                query.value("return_date").toDate(),
-                Transaction::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kTransactionColumns + " FROM transactions WHERE status = 'Active' AND due_date < :current_date ORDER BY due_date");
+    query->bindValue(":current_date", QDate::currentDate());
+    
+    if (executeQuery(*query)) {
+        transactions = mapRows<Transaction>(*query);
     }
     
     return transactions;
 }
 
-QVector<Transaction> DatabaseManager::getTransactionsByDateRange(const QDate& startDate, const QDate& endDate) {
+QVector<Transaction> DatabaseManager::getTransactionsByDateRange(const QDate& startDate, const QDate& endDate,
+                                                                HistoryScope scope) {
     QVector<Transaction> transactions;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM transactions WHERE borrow_date BETWEEN :start_date AND :end_date ORDER BY borrow_date DESC");
-    query.bindValue(":start_date", startDate);
-    query.bindValue(":end_date", endDate);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transactions.append(Transaction(
-                query.value("id").toInt(),
-                query.value("learner_id").toInt(),
-                query.value("book_id").toInt(),
-                query.value("borrow_date").toDate(),
-                query.value("due_date").toDate(),
-                query.value("return_date").toDate(),
-                Transaction::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kTransactionColumns + " FROM " + transactionsTable(scope) +
+                           " WHERE borrow_date BETWEEN :start_date AND :end_date ORDER BY borrow_date DESC");
+    query->bindValue(":start_date", startDate);
+    query->bindValue(":end_date", endDate);
+    
+    if (executeQuery(*query)) {
+        transactions = mapRows<Transaction>(*query);
     }
     
     return transactions;
@@ -435,145 +762,399 @@ QVector<Transaction> DatabaseManager::getTransactionsByDateRange(const QDate& st
 
 // ==================== Business Logic Operations ====================
 
+// Circulation runs as compare-and-set: each UPDATE carries its precondition in
+// the WHERE clause and the affected row count says whether it held. Two desks
+// scanning the same copy cannot both win, and nothing is read back first.
+
 bool DatabaseManager::borrowBook(int learnerId, int bookId, const QDate& borrowDate) {
-    // Start transaction
-    m_database.transaction();
-    
-    // Check if learner has overdue books
-    if (hasOverdueBooks(learnerId)) {
-        setLastError("Learner has overdue books and cannot borrow");
-        m_database.rollback();
+    if (!database().transaction()) {
+        setLastError("Failed to start database transaction");
         return false;
     }
     
-    // Check if book is available
-    Book book = getBookById(bookId);
-    if (book.getId() == -1 || !book.isAvailable()) {
-        setLastError("Book is not available for borrowing");
-        m_database.rollback();
+    // Claim the copy only if it is available and the learner has nothing overdue
+    auto claim = statement(R"(
+        UPDATE books SET status = 'Borrowed'
+        WHERE id = :book_id AND status = 'Available'
+        AND NOT EXISTS (
+            SELECT 1 FROM transactions
+            WHERE learner_id = :learner_id AND status = 'Active' AND due_date < :current_date
+        )
+    )");
+    claim->bindValue(":book_id", bookId);
+    claim->bindValue(":learner_id", learnerId);
+    claim->bindValue(":current_date", QDate::currentDate());
+    
+    if (!executeQuery(*claim)) {
+        database().rollback();
         return false;
     }
-    
-    // Calculate due date
-    QDate dueDate = Transaction::calculateDueDate(borrowDate);
-    
-    // Create transaction
-    Transaction transaction;
-    transaction.setLearnerId(learnerId);
-    transaction.setBookId(bookId);
-    transaction.setBorrowDate(borrowDate);
-    transaction.setDueDate(dueDate);
-    transaction.setStatus(Transaction::Status::Active);
-    
-    if (!addTransaction(transaction)) {
-        m_database.rollback();
+    if (claim->numRowsAffected() != 1) {
+        claim.reset();
+        database().rollback();
+        // Only the failure path pays for finding out which condition failed
+        setLastError(hasOverdueBooks(learnerId) ? "Learner has overdue books and cannot borrow"
+                                                : "Book is not available for borrowing");
         return false;
     }
+    claim.reset();
     
-    // Update book status to Borrowed
-    book.setStatus(Book::Status::Borrowed);
-    if (!updateBook(book)) {
-        m_database.rollback();
+    auto insert = statement(R"(
+        INSERT INTO transactions (learner_id, book_id, borrow_date, due_date, status)
+        VALUES (:learner_id, :book_id, :borrow_date, :due_date, 'Active')
+    )");
+    insert->bindValue(":learner_id", learnerId);
+    insert->bindValue(":book_id", bookId);
+    insert->bindValue(":borrow_date", borrowDate);
+    const QDate dueDate = Transaction::calculateDueDate(borrowDate);
+    insert->bindValue(":due_date", dueDate);
+    
+    if (!executeQuery(*insert)) {
+        database().rollback();
         return false;
     }
+    const int transactionId = insert->lastInsertId().toInt();
+    insert.reset();
     
-    // Commit transaction
-    m_database.commit();
+    LibraryStatistics::PendingChange pendingChange;
+    if (!database().commit()) {
+        setLastError("Failed to commit borrow: " + database().lastError().text());
+        database().rollback();
+        return false;
+    }
+    // Another thread may have cached the pre-commit row meanwhile
+    m_bookCache.remove(bookId);
+    LibraryStatistics::instance().loanOpened(learnerId, dueDate);
+    LibraryStatistics::instance().bookStatusChanged(Book::Status::Available, Book::Status::Borrowed);
+    publish(DomainEvent::Type::BookBorrowed, bookId, learnerId, transactionId);
     return true;
 }
 
 bool DatabaseManager::returnBook(int transactionId, const QDate& returnDate) {
-    // Start transaction
-    m_database.transaction();
+    return closeTransaction(transactionId, Transaction::Status::Returned, Book::Status::Available,
+                            returnDate);
+}
+
+bool DatabaseManager::markBookAsLost(int transactionId) {
+    return closeTransaction(transactionId, Transaction::Status::Lost, Book::Status::Lost, QDate());
+}
+
+// Ends an active loan and sets its copy's status. A valid returnDate is
+// stored; otherwise the existing return_date is kept.
+bool DatabaseManager::closeTransaction(int transactionId, Transaction::Status transactionStatus,
+                                       Book::Status bookStatus, const QDate& returnDate) {
+    if (!database().transaction()) {
+        setLastError("Failed to start database transaction");
+        return false;
+    }
+    
+    auto close = statement(R"(
+        UPDATE transactions
+        SET status = :status, return_date = COALESCE(:return_date, return_date)
+        WHERE id = :id AND status = 'Active'
+        RETURNING book_id, learner_id, due_date
+    )");
+    close->bindValue(":status", Transaction::statusToString(transactionStatus));
+    close->bindValue(":return_date", returnDate.isValid() ? QVariant(returnDate) : QVariant());
+    close->bindValue(":id", transactionId);
     
-    // Get the transaction
-    Transaction transaction = getTransactionById(transactionId);
-    if (transaction.getId() == -1 || !transaction.isActive()) {
+    if (!executeQuery(*close)) {
+        database().rollback();
+        return false;
+    }
+    if (!close->next()) {
+        close.reset();
+        database().rollback();
         setLastError("Transaction not found or not active");
-        m_database.rollback();
         return false;
     }
+    int bookId = close->value(0).toInt();
+    int learnerId = close->value(1).toInt();
+    QDate dueDate = close->value(2).toDate();
+    close.reset();
     
-    // Update transaction
-    transaction.setReturnDate(returnDate);
-    transaction.setStatus(Transaction::Status::Returned);
+    auto release = statement("UPDATE books SET status = :status WHERE id = :id");
+    release->bindValue(":status", Book::statusToString(bookStatus));
+    release->bindValue(":id", bookId);
     
-    if (!updateTransaction(transaction)) {
-        m_database.rollback();
+    if (!executeQuery(*release)) {
+        database().rollback();
         return false;
     }
-    
-    // Update book status to Available
-    Book book = getBookById(transaction.getBookId());
-    if (book.getId() == -1) {
+    if (release->numRowsAffected() != 1) {
+        release.reset();
+        database().rollback();
         setLastError("Book not found");
-        m_database.rollback();
         return false;
     }
+    release.reset();
     
-    book.setStatus(Book::Status::Available);
-    if (!updateBook(book)) {
-        m_database.rollback();
+    LibraryStatistics::PendingChange pendingChange;
+    if (!database().commit()) {
+        setLastError("Failed to commit transaction: " + database().lastError().text());
+        database().rollback();
         return false;
     }
-    
-    // Commit transaction
-    m_database.commit();
+    m_bookCache.remove(bookId);
+    // An active loan's copy is Borrowed
+    LibraryStatistics::instance().loanClosed(learnerId, dueDate);
+    LibraryStatistics::instance().bookStatusChanged(Book::Status::Borrowed, bookStatus);
+    publish(transactionStatus == Transaction::Status::Lost ? DomainEvent::Type::BookLost
+                                                           : DomainEvent::Type::BookReturned,
+            bookId, learnerId, transactionId);
     return true;
 }
 
-bool DatabaseManager::markBookAsLost(int transactionId) {
-    // Start transaction
-    m_database.transaction();
-    
-    // Get the transaction
-    Transaction transaction = getTransactionById(transactionId);
-    if (transaction.getId() == -1 || !transaction.isActive()) {
-        setLastError("Transaction not found or not active");
-        m_database.rollback();
-        return false;
+QVector<DatabaseManager::BorrowResult> DatabaseManager::borrowBooksBatch(const QVector<BorrowRequest>& requests,
+                                                                         const QDate& borrowDate, int chunkSize) {
+    QVector<BorrowResult> results(requests.size());
+    QVector<int> learnerIds;
+    QVector<int> bookIds;
+    learnerIds.reserve(requests.size());
+    bookIds.reserve(requests.size());
+    for (int i = 0; i < requests.size(); ++i) {
+        results[i].learnerId = requests[i].learnerId;
+        results[i].bookId = requests[i].bookId;
+        learnerIds.append(requests[i].learnerId);
+        bookIds.append(requests[i].bookId);
+    }
+    if (requests.isEmpty()) {
+        return results;
+    }
+
+    // One set-based query per rule instead of two lookups per copy
+    QSet<int> overdueLearners;
+    {
+        auto query = statement(R"(
+            SELECT DISTINCT learner_id FROM transactions
+            WHERE status = 'Active' AND due_date < :current_date
+            AND learner_id IN (SELECT value FROM json_each(:ids))
+        )");
+        query->bindValue(":current_date", QDate::currentDate());
+        query->bindValue(":ids", idListJson(learnerIds));
+        if (!executeQuery(*query)) {
+            for (BorrowResult& result : results) {
+                result.error = getLastError();
+            }
+            return results;
+        }
+        while (query->next()) {
+            overdueLearners.insert(query->value(0).toInt());
+        }
     }
-    
-    // Update transaction status to Lost
-    transaction.setStatus(Transaction::Status::Lost);
-    
-    if (!updateTransaction(transaction)) {
-        m_database.rollback();
-        return false;
+
+    QSet<int> availableBooks;
+    {
+        auto query = statement(R"(
+            SELECT id FROM books
+            WHERE status = 'Available' AND id IN (SELECT value FROM json_each(:ids))
+        )");
+        query->bindValue(":ids", idListJson(bookIds));
+        if (!executeQuery(*query)) {
+            for (BorrowResult& result : results) {
+                result.error = getLastError();
+            }
+            return results;
+        }
+        while (query->next()) {
+            availableBooks.insert(query->value(0).toInt());
+        }
     }
-    
-    // Update book status to Lost
-    Book book = getBookById(transaction.getBookId());
-    if (book.getId() == -1) {
-        setLastError("Book not found");
-        m_database.rollback();
-        return false;
+
+    QVector<int> eligible;
+    for (int i = 0; i < requests.size(); ++i) {
+        if (overdueLearners.contains(requests[i].learnerId)) {
+            results[i].error = "Learner has overdue books and cannot borrow";
+        } else if (!availableBooks.remove(requests[i].bookId)) {
+            // Removing also rejects a second request for the same copy
+            results[i].error = "Book is not available for borrowing";
+        } else {
+            eligible.append(i);
+        }
     }
-    
-    book.setStatus(Book::Status::Lost);
-    if (!updateBook(book)) {
-        m_database.rollback();
-        return false;
+
+    const QDate dueDate = Transaction::calculateDueDate(borrowDate);
+    const int step = qMax(1, chunkSize);
+
+    for (int start = 0; start < eligible.size(); start += step) {
+        const int end = qMin(start + step, int(eligible.size()));
+
+        if (!database().transaction()) {
+            for (int k = start; k < end; ++k) {
+                results[eligible[k]].error = "Failed to start database transaction";
+            }
+            continue;
+        }
+
+        {
+            // The status condition still guards against a desk issuing the
+            // same copy since the availability check
+            auto claim = statement(
+                "UPDATE books SET status = 'Borrowed' WHERE id = :book_id AND status = 'Available'");
+            auto insert = statement(R"(
+                INSERT INTO transactions (learner_id, book_id, borrow_date, due_date, status)
+                VALUES (:learner_id, :book_id, :borrow_date, :due_date, 'Active')
+            )");
+            auto unclaim = statement("UPDATE books SET status = 'Available' WHERE id = :book_id");
+
+            for (int k = start; k < end; ++k) {
+                BorrowResult& result = results[eligible[k]];
+
+                claim->bindValue(":book_id", result.bookId);
+                if (!executeQuery(*claim) || claim->numRowsAffected() != 1) {
+                    result.error = "Book is not available for borrowing";
+                    continue;
+                }
+
+                insert->bindValue(":learner_id", result.learnerId);
+                insert->bindValue(":book_id", result.bookId);
+                insert->bindValue(":borrow_date", borrowDate);
+                insert->bindValue(":due_date", dueDate);
+                if (!executeQuery(*insert)) {
+                    result.error = getLastError();
+                    unclaim->bindValue(":book_id", result.bookId);
+                    executeQuery(*unclaim);
+                    continue;
+                }
+
+                result.transactionId = insert->lastInsertId().toInt();
+                result.success = true;
+            }
+        }
+
+        LibraryStatistics::PendingChange pendingChange;
+        bool committed = database().commit();
+        QString commitError = committed ? QString() : database().lastError().text();
+        if (!committed) {
+            database().rollback();
+        }
+
+        for (int k = start; k < end; ++k) {
+            BorrowResult& result = results[eligible[k]];
+            if (!result.success) {
+                continue;
+            }
+            m_bookCache.remove(result.bookId);
+            if (!committed) {
+                result.success = false;
+                result.transactionId = -1;
+                result.error = "Failed to commit batch: " + commitError;
+            } else {
+                LibraryStatistics::instance().loanOpened(result.learnerId, dueDate);
+                LibraryStatistics::instance().bookStatusChanged(Book::Status::Available, Book::Status::Borrowed);
+                publish(DomainEvent::Type::BookBorrowed, result.bookId, result.learnerId, result.transactionId);
+            }
+        }
     }
-    
-    // Commit transaction
-    m_database.commit();
-    return true;
+
+    return results;
+}
+
+QVector<DatabaseManager::ScanReturnResult> DatabaseManager::returnBooksByCodes(const QStringList& bookCodes,
+                                                                               const QDate& returnDate) {
+    QVector<ScanReturnResult> results(bookCodes.size());
+    for (int i = 0; i < bookCodes.size(); ++i) {
+        results[i].bookCode = bookCodes[i];
+    }
+    if (bookCodes.isEmpty()) {
+        return results;
+    }
+
+    if (!database().transaction()) {
+        for (ScanReturnResult& result : results) {
+            result.error = "Failed to start database transaction";
+        }
+        return results;
+    }
+
+    QString batchError;
+    QVector<int> learnerIds(results.size());
+    QVector<QDate> dueDates(results.size());
+    {
+        // The code resolves through the unique book_code index and the loan
+        // through transactions(book_id, status)
+        auto close = statement(R"(
+            UPDATE transactions SET status = 'Returned', return_date = :return_date
+            WHERE status = 'Active' AND book_id = (SELECT id FROM books WHERE book_code = :book_code)
+            RETURNING id, book_id, learner_id, due_date
+        )");
+        auto release = statement("UPDATE books SET status = 'Available' WHERE id = :id");
+        auto known = statement("SELECT 1 FROM books WHERE book_code = :book_code");
+
+        for (int i = 0; i < results.size(); ++i) {
+            ScanReturnResult& result = results[i];
+            close->bindValue(":return_date", returnDate);
+            close->bindValue(":book_code", result.bookCode);
+            if (!executeQuery(*close)) {
+                result.error = getLastError();
+                continue;
+            }
+            if (!close->next()) {
+                close->finish();
+                known->bindValue(":book_code", result.bookCode);
+                bool exists = executeQuery(*known) && known->next();
+                known->finish();
+                result.error = exists ? "Book is not on loan" : "Unknown book code";
+                continue;
+            }
+            result.transactionId = close->value(0).toInt();
+            result.bookId = close->value(1).toInt();
+            learnerIds[i] = close->value(2).toInt();
+            dueDates[i] = close->value(3).toDate();
+            close->finish();
+
+            result.accepted = true;
+
+            release->bindValue(":id", result.bookId);
+            if (!executeQuery(*release)) {
+                // A closed loan with an unreleased copy must not be committed
+                batchError = getLastError();
+                break;
+            }
+        }
+    }
+
+    LibraryStatistics::PendingChange pendingChange;
+    if (batchError.isEmpty() && !database().commit()) {
+        batchError = "Failed to commit returns: " + database().lastError().text();
+    }
+    if (!batchError.isEmpty()) {
+        database().rollback();
+    }
+
+    for (int i = 0; i < results.size(); ++i) {
+        ScanReturnResult& result = results[i];
+        if (result.accepted) {
+            m_bookCache.remove(result.bookId);
+            if (batchError.isEmpty()) {
+                LibraryStatistics::instance().loanClosed(learnerIds[i], dueDates[i]);
+                LibraryStatistics::instance().bookStatusChanged(Book::Status::Borrowed, Book::Status::Available);
+                publish(DomainEvent::Type::BookReturned, result.bookId, learnerIds[i], result.transactionId);
+            }
+        }
+        // Scans accepted or never reached before the failure are rolled back too
+        if (!batchError.isEmpty() && (result.accepted || result.error.isEmpty())) {
+            result.accepted = false;
+            result.transactionId = -1;
+            result.error = batchError;
+        }
+    }
+
+    return results;
 }
 
 bool DatabaseManager::hasOverdueBooks(int learnerId) {
-    QSqlQuery query(m_database);
-    query.prepare(R"(
+    auto query = statement(R"(
         SELECT COUNT(*) FROM transactions 
         WHERE learner_id = :learner_id 
         AND status = 'Active' 
         AND due_date < :current_date
     )");
-    query.bindValue(":learner_id", learnerId);
-    query.bindValue(":current_date", QDate::currentDate());
+    query->bindValue(":learner_id", learnerId);
+    query->bindValue(":current_date", QDate::currentDate());
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt() > 0;
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt() > 0;
     }
     
     return false;
@@ -583,19 +1164,18 @@ double DatabaseManager::calculateUnreturnedBooksAmount(int learnerId) {
     double totalAmount = 0.0;
     
     // Get all active and lost transactions for the learner
-    QSqlQuery query(m_database);
-    query.prepare(R"(
+    auto query = statement(R"(
         SELECT b.price 
         FROM transactions t
         JOIN books b ON t.book_id = b.id
         WHERE t.learner_id = :learner_id 
         AND (t.status = 'Active' OR t.status = 'Lost')
     )");
-    query.bindValue(":learner_id", learnerId);
+    query->bindValue(":learner_id", learnerId);
     
-    if (executeQuery(query)) {
-        while (query.next()) {
-            totalAmount += query.value(0).toDouble();
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            totalAmount += query->value(0).toDouble();
         }
     }
     
@@ -604,59 +1184,253 @@ double DatabaseManager::calculateUnreturnedBooksAmount(int learnerId) {
 
 // ==================== Dashboard Statistics ====================
 
+// Counters are seeded once and then kept current by the mutations above
 DatabaseManager::DashboardStats DatabaseManager::getDashboardStats() {
-    DashboardStats stats;
-    stats.totalBooks = getTotalBookCount();
-    stats.availableBooks = getAvailableBookCount();
-    stats.borrowedBooks = getBorrowedBookCount();
-    stats.totalLearners = getLearnerCount();
-    stats.activeLearners = getActiveLearnerCount();
-    
-    // Get total users count
-    QSqlQuery userQuery("SELECT COUNT(*) FROM users", m_database);
-    if (executeQuery(userQuery) && userQuery.next()) {
-        stats.totalUsers = userQuery.value(0).toInt();
-    }
-    
-    // Get overdue books count
-    QSqlQuery overdueQuery(m_database);
-    overdueQuery.prepare("SELECT COUNT(*) FROM transactions WHERE status = 'Active' AND due_date < :current_date");
-    overdueQuery.bindValue(":current_date", QDate::currentDate());
-    if (executeQuery(overdueQuery) && overdueQuery.next()) {
-        stats.overdueBooks = overdueQuery.value(0).toInt();
+    LibraryStatistics& statistics = LibraryStatistics::instance();
+    if (!statistics.isSeeded() && !statistics.seed()) {
+        setLastError("Failed to count library statistics");
+        return DashboardStats();
     }
-    
-    return stats;
+    return statistics.snapshot();
 }
 
 QVector<Transaction> DatabaseManager::getRecentTransactions(int limit) {
     QVector<Transaction> transactions;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM transactions ORDER BY created_at DESC LIMIT :limit");
-    query.bindValue(":limit", limit);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transactions.append(Transaction(
-                query.value("id").toInt(),
-                query.value("learner_id").toInt(),
-                query.value("book_id").toInt(),
-                query.value("borrow_date").toDate(),
-                query.value("due_date").toDate(),
-                query.value("return_date").toDate(),
-                Transaction::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kTransactionColumns + " FROM transactions ORDER BY created_at DESC LIMIT :limit");
+    query->bindValue(":limit", limit);
+    
+    if (executeQuery(*query)) {
+        transactions = mapRows<Transaction>(*query);
     }
     
     return transactions;
 }
 
+// ==================== Transaction Details ====================
+
+QVector<TransactionDetail> DatabaseManager::getTransactionDetailsByLearner(int learnerId, HistoryScope scope) {
+    QVector<TransactionDetail> details;
+    auto query = statement("SELECT " + kTransactionDetailColumns + " FROM " + transactionDetailFrom(scope) +
+                           " WHERE t.learner_id = :learner_id ORDER BY t.created_at DESC, t.id DESC");
+    query->bindValue(":learner_id", learnerId);
+
+    if (executeQuery(*query)) {
+        details = mapRows<TransactionDetail>(*query);
+    }
+
+    return details;
+}
+
+QVector<TransactionDetail> DatabaseManager::getActiveTransactionDetailsByLearner(int learnerId) {
+    QVector<TransactionDetail> details;
+    auto query = statement("SELECT " + kTransactionDetailColumns + " FROM " + kTransactionDetailFrom +
+                           " WHERE t.learner_id = :learner_id AND t.status = 'Active'"
+                           " ORDER BY t.created_at DESC");
+    query->bindValue(":learner_id", learnerId);
+
+    if (executeQuery(*query)) {
+        details = mapRows<TransactionDetail>(*query);
+    }
+
+    return details;
+}
+
+QVector<TransactionDetail> DatabaseManager::getActiveTransactionDetailsByBookCode(const QString& bookCode) {
+    QVector<TransactionDetail> details;
+    auto query = statement("SELECT " + kTransactionDetailColumns + " FROM " + kTransactionDetailFrom +
+                           " WHERE t.book_id = (SELECT id FROM books WHERE book_code = :book_code)"
+                           " AND t.status = 'Active'"
+                           " ORDER BY t.created_at DESC");
+    query->bindValue(":book_code", bookCode);
+
+    if (executeQuery(*query)) {
+        details = mapRows<TransactionDetail>(*query);
+    }
+
+    return details;
+}
+
+QVector<TransactionDetail> DatabaseManager::getUnpaidLostTransactionDetails(int learnerId) {
+    QVector<TransactionDetail> details;
+    auto query = statement("SELECT " + kTransactionDetailColumns + " FROM " + kTransactionDetailFrom +
+                           " WHERE t.learner_id = :learner_id AND t.status = 'Lost'"
+                           " ORDER BY t.return_date DESC");
+    query->bindValue(":learner_id", learnerId);
+
+    if (executeQuery(*query)) {
+        details = mapRows<TransactionDetail>(*query);
+    }
+
+    return details;
+}
+
+QVector<TransactionDetail> DatabaseManager::getRecentTransactionDetails(int limit) {
+    QVector<TransactionDetail> details;
+    auto query = statement("SELECT " + kTransactionDetailColumns + " FROM " + kTransactionDetailFrom +
+                           " ORDER BY t.created_at DESC LIMIT :limit");
+    query->bindValue(":limit", limit);
+
+    if (executeQuery(*query)) {
+        details = mapRows<TransactionDetail>(*query);
+    }
+
+    return details;
+}
+
+Page<TransactionDetail> DatabaseManager::getTransactionDetailsPage(const PageCursor& after, int limit,
+                                                                   int learnerId, HistoryScope scope) {
+    const QStringList keys = {"t.created_at"};
+    QString filter = learnerId >= 0 ? "t.learner_id = :learner_id" : QString();
+    auto query = statement(keysetSql(kTransactionDetailColumns, transactionDetailFrom(scope), keys, true,
+                                     !after.isStart(), filter, "t.id"));
+    if (learnerId >= 0) {
+        query->bindValue(":learner_id", learnerId);
+    }
+    bindCursor(*query, after, limit);
+
+    if (!executeQuery(*query)) {
+        return Page<TransactionDetail>();
+    }
+    Page<TransactionDetail> page = readPage<TransactionDetail>(*query, keys, after, limit, "t.id");
+
+    // One learner's loans count straight off idx_transactions_learner_created
+    if (after.isStart() && learnerId >= 0) {
+        page.estimatedTotal = estimateRows("SELECT COUNT(*) FROM " + transactionsTable(scope) +
+                                           " WHERE learner_id = :learner_id", ":learner_id", learnerId);
+    }
+    return page;
+}
+
+// ==================== Archive ====================
+
+QString DatabaseManager::archiveDatabasePath() const {
+    return archivePathFor(m_pool.databasePath());
+}
+
+QString DatabaseManager::archivePathFor(const QString& dbPath) {
+    QFileInfo info(dbPath);
+    QString suffix = info.suffix().isEmpty() ? "db" : info.suffix();
+    return info.dir().filePath(info.completeBaseName() + "-archive." + suffix);
+}
+
+int DatabaseManager::archiveClosedTransactions(const QDate& closedBefore, int batchSize) {
+    {
+        auto query = statement("SELECT 1 FROM pragma_database_list WHERE name = 'archive'");
+        if (!executeQuery(*query) || !query->next()) {
+            setLastError("The transaction archive (" + archiveDatabasePath() + ") is not available");
+            return -1;
+        }
+    }
+
+    // payment_items.transaction_id is ON DELETE SET NULL, so with enforcement on
+    // a Paid loan would lose its receipt link when it leaves the live table.
+    // SQLite only re-checks a child key when that column changes, and receipts
+    // read the loan back with HistoryScope::Full.
+    QSqlQuery pragma(database());
+    if (!pragma.exec("PRAGMA foreign_keys = OFF")) {
+        setLastError("Failed to prepare archiving: " + pragma.lastError().text());
+        return -1;
+    }
+
+    const int limit = qMax(1, batchSize);
+    int archived = 0;
+    QString error;
+
+    while (error.isEmpty()) {
+        // Seeks idx_transactions_status_closed, so loans returned early are
+        // archived by their return date, not held back until they fall due
+        QVector<int> ids;
+        {
+            auto select = statement(R"(
+                SELECT id FROM main.transactions
+                WHERE status IN ('Returned', 'Paid')
+                AND COALESCE(return_date, due_date) < :closed_before
+                LIMIT :limit
+            )");
+            select->bindValue(":closed_before", closedBefore);
+            select->bindValue(":limit", limit);
+            if (!executeQuery(*select)) {
+                error = getLastError();
+                break;
+            }
+            while (select->next()) {
+                ids.append(select->value(0).toInt());
+            }
+        }
+        if (ids.isEmpty()) {
+            break;
+        }
+        const QString idJson = idListJson(ids);
+
+        // Copy and delete commit separately: with WAL, a transaction spanning two
+        // files is not atomic across them, and this order means a crash can only
+        // leave a loan in both files, which the next run cleans up
+        if (!database().transaction()) {
+            error = "Failed to start database transaction: " + database().lastError().text();
+            break;
+        }
+        {
+            auto copy = statement("INSERT OR IGNORE INTO archive.transactions (" + kTransactionColumns + ")"
+                                  " SELECT " + kTransactionColumns + " FROM main.transactions"
+                                  " WHERE id IN (SELECT value FROM json_each(:ids))");
+            copy->bindValue(":ids", idJson);
+            if (!executeQuery(*copy)) {
+                error = getLastError();
+            }
+        }
+        if (!error.isEmpty() || !database().commit()) {
+            error = error.isEmpty() ? "Failed to commit: " + database().lastError().text() : error;
+            database().rollback();
+            break;
+        }
+
+        if (!database().transaction()) {
+            error = "Failed to start database transaction: " + database().lastError().text();
+            break;
+        }
+        int removed = 0;
+        {
+            // Only what the archive really holds leaves the live table
+            auto remove = statement(R"(
+                DELETE FROM main.transactions
+                WHERE id IN (SELECT id FROM archive.transactions
+                             WHERE id IN (SELECT value FROM json_each(:ids)))
+            )");
+            remove->bindValue(":ids", idJson);
+            if (executeQuery(*remove)) {
+                removed = remove->numRowsAffected();
+            } else {
+                error = getLastError();
+            }
+        }
+        if (!error.isEmpty() || !database().commit()) {
+            error = error.isEmpty() ? "Failed to commit: " + database().lastError().text() : error;
+            database().rollback();
+            break;
+        }
+
+        if (removed == 0) {
+            error = "No archived rows could be removed from the live table";
+            break;
+        }
+        archived += removed;
+    }
+
+    pragma.exec("PRAGMA foreign_keys = ON");
+
+    if (!error.isEmpty()) {
+        setLastError("Archiving stopped after " + QString::number(archived) + " transactions: " + error);
+        return -1;
+    }
+
+    qDebug() << "Archived" << archived << "transactions closed before" << closedBefore;
+    return archived;
+}
+
 // ==================== Helper Methods ====================
 
 void DatabaseManager::setLastError(const QString& error) {
-    m_lastError = error;
+    m_pool.setLastError(error);
     qDebug() << "DatabaseManager Error:" << error;
 }
 
@@ -668,13 +1442,57 @@ bool DatabaseManager::executeQuery(QSqlQuery& query) {
     return true;
 }
 
+PreparedStatement DatabaseManager::statement(const QString& sql) {
+    return m_pool.statements()->acquire(sql);
+}
+
+int DatabaseManager::estimateRows(const QString& sql, const QString& placeholder, const QVariant& value) {
+    auto query = statement(sql);
+    if (!placeholder.isEmpty()) {
+        query->bindValue(placeholder, value);
+    }
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt();
+    }
+    return -1;
+}
+
+QString DatabaseManager::getLastError() const {
+    return m_pool.lastError();
+}
+
+StatementCache::Stats DatabaseManager::getStatementCacheStats() const {
+    return m_pool.statementStats();
+}
+
+// ==================== Entity Cache ====================
+
+void DatabaseManager::setEntityCacheCapacity(int entries) {
+    m_bookCache.setCapacity(entries);
+    m_learnerCache.setCapacity(entries);
+    m_userCache.setCapacity(entries);
+}
+
+void DatabaseManager::clearEntityCaches() {
+    m_bookCache.clear();
+    m_learnerCache.clear();
+    m_userCache.clear();
+}
+
+DatabaseManager::EntityCacheStats DatabaseManager::getEntityCacheStats() const {
+    EntityCacheStats stats;
+    stats.books = m_bookCache.stats();
+    stats.learners = m_learnerCache.stats();
+    stats.users = m_userCache.stats();
+    return stats;
+}
+
 bool DatabaseManager::userExists(const QString& username) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT COUNT(*) FROM users WHERE username = :username");
-    query.bindValue(":username", username);
+    auto query = statement("SELECT COUNT(*) FROM users WHERE username = :username");
+    query->bindValue(":username", username);
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt() > 0;
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt() > 0;
     }
     
     return false;
@@ -683,157 +1501,252 @@ bool DatabaseManager::userExists(const QString& username) {
 // ==================== Learner Operations ====================
 
 bool DatabaseManager::addLearner(const Learner& learner) {
-    QSqlQuery query(m_database);
-    query.prepare(R"(
+    LibraryStatistics::PendingChange pendingChange;
+    auto query = statement(R"(
         INSERT INTO learners (name, surname, grade, date_of_birth, contact_no)
         VALUES (:name, :surname, :grade, :dob, :contact_no)
     )");
     
-    query.bindValue(":name", learner.getName());
-    query.bindValue(":surname", learner.getSurname());
-    query.bindValue(":grade", learner.getGrade());
-    query.bindValue(":dob", learner.getDateOfBirth());
-    query.bindValue(":contact_no", learner.getContactNo());
+    query->bindValue(":name", learner.getName());
+    query->bindValue(":surname", learner.getSurname());
+    query->bindValue(":grade", learner.getGrade());
+    query->bindValue(":dob", learner.getDateOfBirth());
+    query->bindValue(":contact_no", learner.getContactNo());
     
-    return executeQuery(query);
+    if (!executeQuery(*query)) {
+        return false;
+    }
+    LibraryStatistics::instance().learnersChanged(1);
+    publish(DomainEvent::Type::LearnerAdded, -1, query->lastInsertId().toInt());
+    return true;
 }
 
 bool DatabaseManager::updateLearner(const Learner& learner) {
-    QSqlQuery query(m_database);
-    query.prepare(R"(
+    auto query = statement(R"(
         UPDATE learners SET name = :name, surname = :surname, grade = :grade,
                            date_of_birth = :dob, contact_no = :contact_no
         WHERE id = :id
     )");
     
-    query.bindValue(":id", learner.getId());
-    query.bindValue(":name", learner.getName());
-    query.bindValue(":surname", learner.getSurname());
-    query.bindValue(":grade", learner.getGrade());
-    query.bindValue(":dob", learner.getDateOfBirth());
-    query.bindValue(":contact_no", learner.getContactNo());
+    query->bindValue(":id", learner.getId());
+    query->bindValue(":name", learner.getName());
+    query->bindValue(":surname", learner.getSurname());
+    query->bindValue(":grade", learner.getGrade());
+    query->bindValue(":dob", learner.getDateOfBirth());
+    query->bindValue(":contact_no", learner.getContactNo());
     
-    return executeQuery(query);
+    bool ok = executeQuery(*query);
+    m_learnerCache.remove(learner.getId());
+    if (ok && query->numRowsAffected() == 1) {
+        publish(DomainEvent::Type::LearnerUpdated, -1, learner.getId());
+    }
+    return ok;
 }
 
 bool DatabaseManager::deleteLearner(int learnerId) {
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM learners WHERE id = :id");
-    query.bindValue(":id", learnerId);
-    return executeQuery(query);
+    LibraryStatistics::PendingChange pendingChange;
+    auto query = statement("DELETE FROM learners WHERE id = :id");
+    query->bindValue(":id", learnerId);
+    bool ok = executeQuery(*query);
+    m_learnerCache.remove(learnerId);
+    // An unknown id deletes nothing and has nothing to report
+    if (ok && query->numRowsAffected() == 1) {
+        LibraryStatistics::instance().learnersChanged(-1);
+        publish(DomainEvent::Type::LearnerDeleted, -1, learnerId);
+    }
+    return ok;
 }
 
 Learner DatabaseManager::getLearnerById(int learnerId) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM learners WHERE id = :id");
-    query.bindValue(":id", learnerId);
-    
-    if (executeQuery(query) && query.next()) {
-        return Learner(
-            query.value("id").toInt(),
-            query.value("name").toString(),
-            query.value("surname").toString(),
-            query.value("grade").toString(),
-            query.value("date_of_birth").toDate(),
-            query.value("contact_no").toString(),
-            query.value("created_at").toDateTime()
-        );
+    Learner learner;
+    if (m_learnerCache.lookup(learnerId, &learner)) {
+        return learner;
+    }
+
+    const quint64 generation = m_learnerCache.generation();
+    auto query = statement("SELECT " + kLearnerColumns + " FROM learners WHERE id = :id");
+    query->bindValue(":id", learnerId);
+    
+    if (executeQuery(*query) && query->next()) {
+        learner = RowMapper<Learner>::map(*query);
+        m_learnerCache.insert(learnerId, learner, generation);
+        return learner;
     }
     
     return Learner();
 }
 
+// One statement for any number of ids: the list is bound as a single JSON
+// array and joined through json_each(), so each id is a primary-key seek
+QHash<int, Learner> DatabaseManager::getLearnersByIds(const QVector<int>& learnerIds) {
+    QHash<int, Learner> learners;
+    if (learnerIds.isEmpty()) {
+        return learners;
+    }
+
+    auto query = statement("SELECT " + kLearnerColumns +
+                           " FROM learners WHERE id IN (SELECT value FROM json_each(:ids))");
+    query->bindValue(":ids", idListJson(learnerIds));
+
+    if (executeQuery(*query)) {
+        learners.reserve(learnerIds.size());
+        while (query->next()) {
+            Learner learner = RowMapper<Learner>::map(*query);
+            learners.insert(learner.getId(), learner);
+        }
+    }
+
+    return learners;
+}
+
 QVector<Learner> DatabaseManager::getAllLearners() {
     QVector<Learner> learners;
-    QSqlQuery query("SELECT * FROM learners ORDER BY surname, name", m_database);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            learners.append(Learner(
-                query.value("id").toInt(),
-                query.value("name").toString(),
-                query.value("surname").toString(),
-                query.value("grade").toString(),
-                query.value("date_of_birth").toDate(),
-                query.value("contact_no").toString(),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kLearnerColumns + " FROM learners ORDER BY surname, name");
+    
+    if (executeQuery(*query)) {
+        learners = mapRows<Learner>(*query);
     }
     
     return learners;
 }
 
+Page<Learner> DatabaseManager::getLearnersPage(LearnerSort sort, const PageCursor& after, int limit,
+                                               const QString& grade) {
+    // Surname order within a grade reads idx_learners_grade_surname_name
+    const QStringList keys = learnerSortColumns(sort);
+    QString filter = grade.isEmpty() ? QString() : "grade = :grade";
+    auto query = statement(keysetSql(kLearnerColumns, "learners", keys, false, !after.isStart(), filter));
+    if (!grade.isEmpty()) {
+        query->bindValue(":grade", grade);
+    }
+    bindCursor(*query, after, limit);
+
+    if (!executeQuery(*query)) {
+        return Page<Learner>();
+    }
+    Page<Learner> page = readPage<Learner>(*query, keys, after, limit);
+
+    if (after.isStart()) {
+        if (!grade.isEmpty()) {
+            page.estimatedTotal = estimateRows("SELECT COUNT(*) FROM learners WHERE grade = :grade", ":grade", grade);
+        } else if (LibraryStatistics::instance().isSeeded()) {
+            page.estimatedTotal = LibraryStatistics::instance().snapshot().totalLearners;
+        }
+    }
+    return page;
+}
+
 QVector<Learner> DatabaseManager::getLearnersByGrade(const QString& grade) {
     QVector<Learner> learners;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM learners WHERE grade = :grade ORDER BY surname, name");
-    query.bindValue(":grade", grade);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            learners.append(Learner(
-                query.value("id").toInt(),
-                query.value("name").toString(),
-                query.value("surname").toString(),
-                query.value("grade").toString(),
-                query.value("date_of_birth").toDate(),
-                query.value("contact_no").toString(),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kLearnerColumns + " FROM learners WHERE grade = :grade ORDER BY surname, name");
+    query->bindValue(":grade", grade);
+    
+    if (executeQuery(*query)) {
+        learners = mapRows<Learner>(*query);
     }
     
     return learners;
 }
 
-QVector<Learner> DatabaseManager::searchLearners(const QString& searchTerm) {
+QVector<Learner> DatabaseManager::searchLearners(const QString& searchTerm, int limit) {
     QVector<Learner> learners;
-    QSqlQuery query(m_database);
-    query.prepare(R"(
-        SELECT * FROM learners 
-        WHERE name LIKE :search OR surname LIKE :search OR 
-              CAST(id AS TEXT) LIKE :search
-        ORDER BY surname, name
-    )");
+    bool useFts = hasFullTextSearch();
+
+    // A learner number typed into the search box goes straight to that learner
+    bool isNumber = false;
+    int learnerId = searchTerm.trimmed().toInt(&isNumber);
+    if (useFts && isNumber) {
+        Learner learner = getLearnerById(learnerId);
+        if (learner.getId() != -1) {
+            learners.append(learner);
+        }
+    }
+
+    int longestWord = 0;
+    QString match = ftsMatchExpression(searchTerm, &longestWord);
+    if (useFts && match.isEmpty()) {
+        return learners;
+    }
+
+    auto query = statement(learnerSearchSql(useFts, longestWord).arg(selectColumns<Learner>("l")));
+    if (useFts) {
+        query->bindValue(":match", match);
+    } else {
+        query->bindValue(":search", "%" + searchTerm + "%");
+    }
+    query->bindValue(":limit", limit);
+    query->bindValue(":offset", 0);
     
-    QString searchPattern = "%" + searchTerm + "%";
-    query.bindValue(":search", searchPattern);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            learners.append(Learner(
-                query.value("id").toInt(),
-                query.value("name").toString(),
-                query.value("surname").toString(),
-                query.value("grade").toString(),
-                query.value("date_of_birth").toDate(),
-                query.value("contact_no").toString(),
-                query.value("created_at").toDateTime()
-            ));
+    if (executeQuery(*query)) {
+        while (query->next()) {
+            // Already added by the id lookup above
+            if (useFts && isNumber && query->value(RowMapper<Learner>::Id).toInt() == learnerId) {
+                continue;
+            }
+            learners.append(RowMapper<Learner>::map(*query));
         }
     }
     
     return learners;
 }
 
+// Relevance order has no index to seek by, so search pages continue from an
+// offset; each page scores the matches again, which costs less than reading them
+Page<Learner> DatabaseManager::searchLearnersPage(const QString& searchTerm, const PageCursor& after, int limit) {
+    Page<Learner> page;
+    bool useFts = hasFullTextSearch();
+
+    // A learner number goes first, as in searchLearners()
+    bool isNumber = false;
+    int learnerId = searchTerm.trimmed().toInt(&isNumber);
+    const int skipId = useFts && isNumber ? learnerId : -1;
+
+    int longestWord = 0;
+    QString match = ftsMatchExpression(searchTerm, &longestWord);
+    if (useFts && match.isEmpty()) {
+        return page;
+    }
+
+    auto query = statement(learnerSearchSql(useFts, longestWord).arg(selectColumns<Learner>("l")));
+    if (useFts) {
+        query->bindValue(":match", match);
+    } else {
+        query->bindValue(":search", "%" + searchTerm + "%");
+    }
+    query->bindValue(":limit", limit + 1);
+    query->bindValue(":offset", after.offset);
+
+    if (!executeQuery(*query)) {
+        return page;
+    }
+    page = readOffsetPage<Learner>(*query, after, limit, skipId);
+
+    if (after.isStart() && skipId >= 0) {
+        Learner learner = getLearnerById(skipId);
+        if (learner.getId() != -1) {
+            page.items.prepend(learner);
+        }
+    }
+    return page;
+}
+
 int DatabaseManager::getLearnerCount() {
-    QSqlQuery query("SELECT COUNT(*) FROM learners", m_database);
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt();
+    auto query = statement("SELECT COUNT(*) FROM learners");
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt();
     }
     return 0;
 }
 
 int DatabaseManager::getActiveLearnerCount() {
-    QSqlQuery query(R"(
+    auto query = statement(R"(
         SELECT COUNT(DISTINCT learner_id) 
         FROM transactions 
         WHERE status = 'Active'
-    )", m_database);
+    )");
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt();
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt();
     }
     return 0;
 }
@@ -841,94 +1754,147 @@ int DatabaseManager::getActiveLearnerCount() {
 // ==================== Book Operations ====================
 
 bool DatabaseManager::addBook(const Book& book) {
-    QSqlQuery query(m_database);
-    query.prepare(R"(
+    LibraryStatistics::PendingChange pendingChange;
+    auto query = statement(R"(
         INSERT INTO books (book_code, isbn, title, author, subject, grade, price, status)
         VALUES (:book_code, :isbn, :title, :author, :subject, :grade, :price, :status)
     )");
     
-    query.bindValue(":book_code", book.getBookCode());
-    query.bindValue(":isbn", book.getIsbn());
-    query.bindValue(":title", book.getTitle());
-    query.bindValue(":author", book.getAuthor());
-    query.bindValue(":subject", book.getSubject());
-    query.bindValue(":grade", book.getGrade());
-    query.bindValue(":price", book.getPrice());
-    query.bindValue(":status", Book::statusToString(book.getStatus()));
+    query->bindValue(":book_code", book.getBookCode());
+    query->bindValue(":isbn", book.getIsbn());
+    query->bindValue(":title", book.getTitle());
+    query->bindValue(":author", book.getAuthor());
+    query->bindValue(":subject", book.getSubject());
+    query->bindValue(":grade", book.getGrade());
+    query->bindValue(":price", book.getPrice());
+    query->bindValue(":status", Book::statusToString(book.getStatus()));
     
-    return executeQuery(query);
+    if (!executeQuery(*query)) {
+        return false;
+    }
+    LibraryStatistics::instance().booksAdded(book.getStatus());
+    publish(DomainEvent::Type::BookAdded, query->lastInsertId().toInt(), -1);
+    return true;
 }
 
 bool DatabaseManager::updateBook(const Book& book) {
-    QSqlQuery query(m_database);
-    query.prepare(R"(
+    // The edit form can change the status, so the old one is read in the same
+    // transaction as the update. A loan committed after the read makes the
+    // update fail (its snapshot is stale) rather than miscount the statistics.
+    if (!database().transaction()) {
+        setLastError("Failed to start database transaction");
+        return false;
+    }
+
+    auto current = statement("SELECT status FROM books WHERE id = :id");
+    current->bindValue(":id", book.getId());
+    if (!executeQuery(*current)) {
+        database().rollback();
+        return false;
+    }
+    if (!current->next()) {
+        current.reset();
+        database().rollback();
+        setLastError("Book not found");
+        return false;
+    }
+    const Book::Status previousStatus = Book::stringToStatus(current->value(0).toString());
+    current.reset();
+
+    auto query = statement(R"(
         UPDATE books SET book_code = :book_code, isbn = :isbn, title = :title,
                         author = :author, subject = :subject, grade = :grade,
                         price = :price, status = :status
         WHERE id = :id
     )");
     
-    query.bindValue(":id", book.getId());
-    query.bindValue(":book_code", book.getBookCode());
-    query.bindValue(":isbn", book.getIsbn());
-    query.bindValue(":title", book.getTitle());
-    query.bindValue(":author", book.getAuthor());
-    query.bindValue(":subject", book.getSubject());
-    query.bindValue(":grade", book.getGrade());
-    query.bindValue(":price", book.getPrice());
-    query.bindValue(":status", Book::statusToString(book.getStatus()));
-    
-    return executeQuery(query);
+    query->bindValue(":id", book.getId());
+    query->bindValue(":book_code", book.getBookCode());
+    query->bindValue(":isbn", book.getIsbn());
+    query->bindValue(":title", book.getTitle());
+    query->bindValue(":author", book.getAuthor());
+    query->bindValue(":subject", book.getSubject());
+    query->bindValue(":grade", book.getGrade());
+    query->bindValue(":price", book.getPrice());
+    query->bindValue(":status", Book::statusToString(book.getStatus()));
+    
+    if (!executeQuery(*query)) {
+        database().rollback();
+        return false;
+    }
+    query.reset();
+
+    LibraryStatistics::PendingChange pendingChange;
+    if (!database().commit()) {
+        setLastError("Failed to commit book update: " + database().lastError().text());
+        database().rollback();
+        return false;
+    }
+    m_bookCache.remove(book.getId());
+    LibraryStatistics::instance().bookStatusChanged(previousStatus, book.getStatus());
+    publish(DomainEvent::Type::BookUpdated, book.getId(), -1);
+    return true;
 }
 
 bool DatabaseManager::deleteBook(int bookId) {
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM books WHERE id = :id");
-    query.bindValue(":id", bookId);
-    return executeQuery(query);
+    LibraryStatistics::PendingChange pendingChange;
+    auto query = statement("DELETE FROM books WHERE id = :id RETURNING status");
+    query->bindValue(":id", bookId);
+    bool ok = executeQuery(*query);
+    m_bookCache.remove(bookId);
+    if (ok && query->next()) {
+        LibraryStatistics::instance().bookRemoved(Book::stringToStatus(query->value(0).toString()));
+        publish(DomainEvent::Type::BookDeleted, bookId, -1);
+    }
+    return ok;
 }
 
 Book DatabaseManager::getBookById(int bookId) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM books WHERE id = :id");
-    query.bindValue(":id", bookId);
-    
-    if (executeQuery(query) && query.next()) {
-        return Book(
-            query.value("id").toInt(),
-            query.value("book_code").toString(),
-            query.value("isbn").toString(),
-            query.value("title").toString(),
-            query.value("author").toString(),
-            query.value("subject").toString(),
-            query.value("grade").toString(),
-            query.value("price").toDouble(),
-            Book::stringToStatus(query.value("status").toString()),
-            query.value("created_at").toDateTime()
-        );
+    Book book;
+    if (m_bookCache.lookup(bookId, &book)) {
+        return book;
+    }
+
+    const quint64 generation = m_bookCache.generation();
+    auto query = statement("SELECT " + kBookColumns + " FROM books WHERE id = :id");
+    query->bindValue(":id", bookId);
+    
+    if (executeQuery(*query) && query->next()) {
+        book = RowMapper<Book>::map(*query);
+        m_bookCache.insert(bookId, book, generation);
+        return book;
     }
     
     return Book();
 }
 
+QHash<int, Book> DatabaseManager::getBooksByIds(const QVector<int>& bookIds) {
+    QHash<int, Book> books;
+    if (bookIds.isEmpty()) {
+        return books;
+    }
+
+    auto query = statement("SELECT " + kBookColumns +
+                           " FROM books WHERE id IN (SELECT value FROM json_each(:ids))");
+    query->bindValue(":ids", idListJson(bookIds));
+
+    if (executeQuery(*query)) {
+        books.reserve(bookIds.size());
+        while (query->next()) {
+            Book book = RowMapper<Book>::map(*query);
+            books.insert(book.getId(), book);
+        }
+    }
+
+    return books;
+}
+
 Book DatabaseManager::getBookByCode(const QString& bookCode) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM books WHERE book_code = :book_code");
-    query.bindValue(":book_code", bookCode);
-    
-    if (executeQuery(query) && query.next()) {
-        return Book(
-            query.value("id").toInt(),
-            query.value("book_code").toString(),
-            query.value("isbn").toString(),
-            query.value("title").toString(),
-            query.value("author").toString(),
-            query.value("subject").toString(),
-            query.value("grade").toString(),
-            query.value("price").toDouble(),
-            Book::stringToStatus(query.value("status").toString()),
-            query.value("created_at").toDateTime()
-        );
+    auto query = statement("SELECT " + kBookColumns + " FROM books WHERE book_code = :book_code");
+    query->bindValue(":book_code", bookCode);
+    
+    if (executeQuery(*query) && query->next()) {
+        return RowMapper<Book>::map(*query);
     }
     
     return Book();
@@ -936,49 +1902,48 @@ Book DatabaseManager::getBookByCode(const QString& bookCode) {
 
 QVector<Book> DatabaseManager::getAllBooks() {
     QVector<Book> books;
-    QSqlQuery query("SELECT * FROM books ORDER BY title", m_database);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            books.append(Book(
-                query.value("id").toInt(),
-                query.value("book_code").toString(),
-                query.value("isbn").toString(),
-                query.value("title").toString(),
-                query.value("author").toString(),
-                query.value("subject").toString(),
-                query.value("grade").toString(),
-                query.value("price").toDouble(),
-                Book::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kBookColumns + " FROM books ORDER BY title");
+    
+    if (executeQuery(*query)) {
+        books = mapRows<Book>(*query);
     }
     
     return books;
 }
 
+Page<BookListRow> DatabaseManager::getBooksPage(BookSort sort, const PageCursor& after, int limit,
+                                                const QString& grade) {
+    // Title order within a grade reads idx_books_grade_title
+    const QStringList keys = bookSortColumns(sort);
+    QString filter = grade.isEmpty() ? QString() : "grade = :grade";
+    auto query = statement(keysetSql(kBookListColumns, "books", keys, false, !after.isStart(), filter));
+    if (!grade.isEmpty()) {
+        query->bindValue(":grade", grade);
+    }
+    bindCursor(*query, after, limit);
+
+    if (!executeQuery(*query)) {
+        return Page<BookListRow>();
+    }
+    Page<BookListRow> page = readPage<BookListRow>(*query, keys, after, limit);
+
+    if (after.isStart()) {
+        if (!grade.isEmpty()) {
+            page.estimatedTotal = estimateRows("SELECT COUNT(*) FROM books WHERE grade = :grade", ":grade", grade);
+        } else if (LibraryStatistics::instance().isSeeded()) {
+            page.estimatedTotal = LibraryStatistics::instance().snapshot().totalBooks;
+        }
+    }
+    return page;
+}
+
 QVector<Book> DatabaseManager::getBooksByGrade(const QString& grade) {
     QVector<Book> books;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM books WHERE grade = :grade ORDER BY title");
-    query.bindValue(":grade", grade);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            books.append(Book(
-                query.value("id").toInt(),
-                query.value("book_code").toString(),
-                query.value("isbn").toString(),
-                query.value("title").toString(),
-                query.value("author").toString(),
-                query.value("subject").toString(),
-                query.value("grade").toString(),
-                query.value("price").toDouble(),
-                Book::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kBookColumns + " FROM books WHERE grade = :grade ORDER BY title");
+    query->bindValue(":grade", grade);
+    
+    if (executeQuery(*query)) {
+        books = mapRows<Book>(*query);
     }
     
     return books;
@@ -986,25 +1951,11 @@ QVector<Book> DatabaseManager::getBooksByGrade(const QString& grade) {
 
 QVector<Book> DatabaseManager::getBooksBySubject(const QString& subject) {
     QVector<Book> books;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM books WHERE subject = :subject ORDER BY title");
-    query.bindValue(":subject", subject);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            books.append(Book(
-                query.value("id").toInt(),
-                query.value("book_code").toString(),
-                query.value("isbn").toString(),
-                query.value("title").toString(),
-                query.value("author").toString(),
-                query.value("subject").toString(),
-                query.value("grade").toString(),
-                query.value("price").toDouble(),
-                Book::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kBookColumns + " FROM books WHERE subject = :subject ORDER BY title");
+    query->bindValue(":subject", subject);
+    
+    if (executeQuery(*query)) {
+        books = mapRows<Book>(*query);
     }
     
     return books;
@@ -1012,107 +1963,109 @@ QVector<Book> DatabaseManager::getBooksBySubject(const QString& subject) {
 
 QVector<Book> DatabaseManager::getBooksByStatus(Book::Status status) {
     QVector<Book> books;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM books WHERE status = :status ORDER BY title");
-    query.bindValue(":status", Book::statusToString(status));
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            books.append(Book(
-                query.value("id").toInt(),
-                query.value("book_code").toString(),
-                query.value("isbn").toString(),
-                query.value("title").toString(),
-                query.value("author").toString(),
-                query.value("subject").toString(),
-                query.value("grade").toString(),
-                query.value("price").toDouble(),
-                Book::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kBookColumns + " FROM books WHERE status = :status ORDER BY title");
+    query->bindValue(":status", Book::statusToString(status));
+    
+    if (executeQuery(*query)) {
+        books = mapRows<Book>(*query);
     }
     
     return books;
 }
 
-QVector<Book> DatabaseManager::searchBooks(const QString& searchTerm) {
+QVector<Book> DatabaseManager::searchBooks(const QString& searchTerm, int limit) {
     QVector<Book> books;
-    QSqlQuery query(m_database);
-    query.prepare(R"(
-        SELECT * FROM books 
-        WHERE title LIKE :search OR author LIKE :search OR 
-              book_code LIKE :search OR isbn LIKE :search
-        ORDER BY title
-    )");
+    bool useFts = hasFullTextSearch();
+
+    int longestWord = 0;
+    QString match = ftsMatchExpression(searchTerm, &longestWord);
+    if (useFts && match.isEmpty()) {
+        return books;
+    }
+
+    auto query = statement(bookSearchSql(useFts, longestWord).arg(selectColumns<Book>("b")));
+    if (useFts) {
+        query->bindValue(":match", match);
+    } else {
+        query->bindValue(":search", "%" + searchTerm + "%");
+    }
+    query->bindValue(":limit", limit);
+    query->bindValue(":offset", 0);
     
-    QString searchPattern = "%" + searchTerm + "%";
-    query.bindValue(":search", searchPattern);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            books.append(Book(
-                query.value("id").toInt(),
-                query.value("book_code").toString(),
-                query.value("isbn").toString(),
-                query.value("title").toString(),
-                query.value("author").toString(),
-                query.value("subject").toString(),
-                query.value("grade").toString(),
-                query.value("price").toDouble(),
-                Book::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    if (executeQuery(*query)) {
+        books = mapRows<Book>(*query);
     }
     
     return books;
 }
 
+// Paged like searchLearnersPage()
+Page<BookListRow> DatabaseManager::searchBooksPage(const QString& searchTerm, const PageCursor& after, int limit) {
+    bool useFts = hasFullTextSearch();
+
+    int longestWord = 0;
+    QString match = ftsMatchExpression(searchTerm, &longestWord);
+    if (useFts && match.isEmpty()) {
+        return Page<BookListRow>();
+    }
+
+    auto query = statement(bookSearchSql(useFts, longestWord).arg(selectColumns<BookListRow>("b")));
+    if (useFts) {
+        query->bindValue(":match", match);
+    } else {
+        query->bindValue(":search", "%" + searchTerm + "%");
+    }
+    query->bindValue(":limit", limit + 1);
+    query->bindValue(":offset", after.offset);
+
+    if (!executeQuery(*query)) {
+        return Page<BookListRow>();
+    }
+    return readOffsetPage<BookListRow>(*query, after, limit);
+}
+
 bool DatabaseManager::bookCodeExists(const QString& bookCode) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT COUNT(*) FROM books WHERE book_code = :book_code");
-    query.bindValue(":book_code", bookCode);
+    auto query = statement("SELECT COUNT(*) FROM books WHERE book_code = :book_code");
+    query->bindValue(":book_code", bookCode);
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt() > 0;
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt() > 0;
     }
     
     return false;
 }
 
 int DatabaseManager::getBookCountByISBN(const QString& isbn) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT COUNT(*) FROM books WHERE isbn = :isbn");
-    query.bindValue(":isbn", isbn);
+    auto query = statement("SELECT COUNT(*) FROM books WHERE isbn = :isbn");
+    query->bindValue(":isbn", isbn);
     
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt();
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt();
     }
     
     return 0;
 }
 
 int DatabaseManager::getTotalBookCount() {
-    QSqlQuery query("SELECT COUNT(*) FROM books", m_database);
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt();
+    auto query = statement("SELECT COUNT(*) FROM books");
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt();
     }
     return 0;
 }
 
 int DatabaseManager::getAvailableBookCount() {
-    QSqlQuery query("SELECT COUNT(*) FROM books WHERE status = 'Available'", m_database);
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt();
+    auto query = statement("SELECT COUNT(*) FROM books WHERE status = 'Available'");
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt();
     }
     return 0;
 }
 
 int DatabaseManager::getBorrowedBookCount() {
-    QSqlQuery query("SELECT COUNT(*) FROM books WHERE status = 'Borrowed'", m_database);
-    if (executeQuery(query) && query.next()) {
-        return query.value(0).toInt();
+    auto query = statement("SELECT COUNT(*) FROM books WHERE status = 'Borrowed'");
+    if (executeQuery(*query) && query->next()) {
+        return query->value(0).toInt();
     }
     return 0;
 }
@@ -1120,88 +2073,70 @@ int DatabaseManager::getBorrowedBookCount() {
 // ==================== Transaction Operations ====================
 
 bool DatabaseManager::addTransaction(const Transaction& transaction) {
-    QSqlQuery query(m_database);
-    query.prepare(R"(
+    auto query = statement(R"(
         INSERT INTO transactions (learner_id, book_id, borrow_date, due_date, 
                                  return_date, status)
         VALUES (:learner_id, :book_id, :borrow_date, :due_date, 
                 :return_date, :status)
     )");
     
-    query.bindValue(":learner_id", transaction.getLearnerId());
-    query.bindValue(":book_id", transaction.getBookId());
-    query.bindValue(":borrow_date", transaction.getBorrowDate());
-    query.bindValue(":due_date", transaction.getDueDate());
-    query.bindValue(":return_date", 
+    query->bindValue(":learner_id", transaction.getLearnerId());
+    query->bindValue(":book_id", transaction.getBookId());
+    query->bindValue(":borrow_date", transaction.getBorrowDate());
+    query->bindValue(":due_date", transaction.getDueDate());
+    query->bindValue(":return_date", 
                    transaction.getReturnDate().isValid() ? 
                    transaction.getReturnDate() : QVariant());
-    query.bindValue(":status", Transaction::statusToString(transaction.getStatus()));
+    query->bindValue(":status", Transaction::statusToString(transaction.getStatus()));
     
-    return executeQuery(query);
+    // Raw edits can open or close loans; counters are recounted on next read
+    bool ok = executeQuery(*query);
+    LibraryStatistics::instance().invalidate();
+    return ok;
 }
 
 bool DatabaseManager::updateTransaction(const Transaction& transaction) {
-    QSqlQuery query(m_database);
-    query.prepare(R"(
+    auto query = statement(R"(
         UPDATE transactions SET learner_id = :learner_id, book_id = :book_id,
                                borrow_date = :borrow_date, due_date = :due_date,
                                return_date = :return_date, status = :status
         WHERE id = :id
     )");
     
-    query.bindValue(":id", transaction.getId());
-    query.bindValue(":learner_id", transaction.getLearnerId());
-    query.bindValue(":book_id", transaction.getBookId());
-    query.bindValue(":borrow_date", transaction.getBorrowDate());
-    query.bindValue(":due_date", transaction.getDueDate());
-    query.bindValue(":return_date", 
+    query->bindValue(":id", transaction.getId());
+    query->bindValue(":learner_id", transaction.getLearnerId());
+    query->bindValue(":book_id", transaction.getBookId());
+    query->bindValue(":borrow_date", transaction.getBorrowDate());
+    query->bindValue(":due_date", transaction.getDueDate());
+    query->bindValue(":return_date", 
                    transaction.getReturnDate().isValid() ? 
                    transaction.getReturnDate() : QVariant());
-    query.bindValue(":status", Transaction::statusToString(transaction.getStatus()));
+    query->bindValue(":status", Transaction::statusToString(transaction.getStatus()));
     
-    return executeQuery(query);
+    bool ok = executeQuery(*query);
+    LibraryStatistics::instance().invalidate();
+    return ok;
 }
 
-Transaction DatabaseManager::getTransactionById(int transactionId) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM transactions WHERE id = :id");
-    query.bindValue(":id", transactionId);
+Transaction DatabaseManager::getTransactionById(int transactionId, HistoryScope scope) {
+    auto query = statement("SELECT " + kTransactionColumns + " FROM " + transactionsTable(scope) + " WHERE id = :id");
+    query->bindValue(":id", transactionId);
     
-    if (executeQuery(query) && query.next()) {
-        return Transaction(
-            query.value("id").toInt(),
-            query.value("learner_id").toInt(),
-            query.value("book_id").toInt(),
-            query.value("borrow_date").toDate(),
-            query.value("due_date").toDate(),
-            query.value("return_date").toDate(),
-            Transaction::stringToStatus(query.value("status").toString()),
-            query.value("created_at").toDateTime()
-        );
+    if (executeQuery(*query) && query->next()) {
+        return RowMapper<Transaction>::map(*query);
     }
     
     return Transaction();
 }
 
-QVector<Transaction> DatabaseManager::getTransactionsByLearnerId(int learnerId) {
+QVector<Transaction> DatabaseManager::getTransactionsByLearnerId(int learnerId, HistoryScope scope) {
     QVector<Transaction> transactions;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM transactions WHERE learner_id = :learner_id ORDER BY created_at DESC");
-    query.bindValue(":learner_id", learnerId);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transactions.append(Transaction(
-                query.value("id").toInt(),
-                query.value("learner_id").toInt(),
-                query.value("book_id").toInt(),
-                query.value("borrow_date").toDate(),
-                query.value("due_date").toDate(),
-                query.value("return_date").toDate(),
-                Transaction::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kTransactionColumns + " FROM " + transactionsTable(scope) +
+                           " WHERE learner_id = :learner_id ORDER BY created_at DESC");
+    query->bindValue(":learner_id", learnerId);
+    
+    if (executeQuery(*query)) {
+        transactions = mapRows<Transaction>(*query);
     }
     
     return transactions;
@@ -1209,23 +2144,11 @@ QVector<Transaction> DatabaseManager::getTransactionsByLearnerId(int learnerId)
 
 QVector<Transaction> DatabaseManager::getActiveTransactionsByLearnerId(int learnerId) {
     QVector<Transaction> transactions;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM transactions WHERE learner_id = :learner_id AND status = 'Active' ORDER BY created_at DESC");
-    query.bindValue(":learner_id", learnerId);
-    
-    if (executeQuery(query)) {
-        while (query.next()) {
-            transactions.append(Transaction(
-                query.value("id").toInt(),
-                query.value("learner_id").toInt(),
-                query.value("book_id").toInt(),
-                query.value("borrow_date").toDate(),
-                query.value("due_date").toDate(),
-                query.value("return_date").toDate(),
-                Transaction::stringToStatus(query.value("status").toString()),
-                query.value("created_at").toDateTime()
-            ));
-        }
+    auto query = statement("SELECT " + kTransactionColumns + " FROM transactions WHERE learner_id = :learner_id AND status = 'Active' ORDER BY created_at DESC");
+    query->bindValue(":learner_id", learnerId);
+    
+    if (executeQuery(*query)) {
+        transactions = mapRows<Transaction>(*query);
     }
     
     return transactions;
@@ -1235,83 +2158,18 @@ QVector<Transaction> DatabaseManager::getActiveTransactionsByLearnerId(int learn
 
 
 
-bool DatabaseManager::createPaymentTables() {
-    QSqlQuery query(m_database);
-
-    // Ensure foreign key enforcement is enabled for this connection (SQLite)
-    query.exec("PRAGMA foreign_keys = ON");
-
-    if (!m_database.transaction()) {
-        setLastError("Failed to start DB transaction for creating payment tables");
-    }
-
-    bool ok = true;
-
-    // UPDATED: payment_date will be auto-generated with DEFAULT CURRENT_TIMESTAMP
-    ok &= query.exec(R"SQL(
-        CREATE TABLE IF NOT EXISTS payments (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            receipt_no TEXT UNIQUE,
-            learner_id INTEGER,
-            amount REAL,
-            processed_by INTEGER,
-            payment_date DATETIME DEFAULT CURRENT_TIMESTAMP,
-            notes TEXT,
-            FOREIGN KEY (learner_id) REFERENCES learners(id) ON DELETE SET NULL ON UPDATE CASCADE,
-            FOREIGN KEY (processed_by) REFERENCES users(id) ON DELETE SET NULL ON UPDATE CASCADE
-        )
-    )SQL");
-    if (!ok) {
-        setLastError("Failed to create payments table: " + query.lastError().text());
-    }
-
-    ok &= query.exec(R"SQL(
-        CREATE TABLE IF NOT EXISTS payment_items (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            payment_id INTEGER NOT NULL,
-            transaction_id INTEGER,
-            book_id INTEGER,
-            amount REAL,
-            FOREIGN KEY (payment_id) REFERENCES payments(id) ON DELETE CASCADE ON UPDATE CASCADE,
-            FOREIGN KEY (transaction_id) REFERENCES transactions(id) ON DELETE SET NULL ON UPDATE CASCADE,
-            FOREIGN KEY (book_id) REFERENCES books(id) ON DELETE SET NULL ON UPDATE CASCADE
-        )
-    )SQL");
-    if (!ok) {
-        setLastError("Failed to create payment_items table: " + query.lastError().text());
-    }
-
-    // Helpful indexes
-    ok &= query.exec("CREATE INDEX IF NOT EXISTS idx_payments_learner_id ON payments(learner_id)");
-    ok &= query.exec("CREATE INDEX IF NOT EXISTS idx_payments_processed_by ON payments(processed_by)");
-    ok &= query.exec("CREATE INDEX IF NOT EXISTS idx_payment_items_payment_id ON payment_items(payment_id)");
-    ok &= query.exec("CREATE INDEX IF NOT EXISTS idx_payment_items_transaction_id ON payment_items(transaction_id)");
-    ok &= query.exec("CREATE INDEX IF NOT EXISTS idx_payment_items_book_id ON payment_items(book_id)");
-
-    if (!m_database.commit()) {
-        m_database.rollback();
-        setLastError("Failed to commit DB transaction for creating payment tables");
-        return false;
-    }
-
-    return ok;
-}
-
-
 bool DatabaseManager::processPayment(Payments& payment, const QVector<int>& transactionIds) {
     if (transactionIds.isEmpty()) {
-        m_lastError = "No transactions selected for payment";
+        setLastError("No transactions selected for payment");
         return false;
     }
 
     // Start transaction
-    if (!m_database.transaction()) {
-        m_lastError = "Failed to start database transaction";
+    if (!database().transaction()) {
+        setLastError("Failed to start database transaction");
         return false;
     }
 
-    QSqlQuery query(m_database);
-
     try {
         // Generate receipt number if not set
         if (payment.getReceiptNo().isEmpty()) {
@@ -1319,23 +2177,24 @@ bool DatabaseManager::processPayment(Payments& payment, const QVector<int>& tran
         }
 
         // Insert payment record - FIXED: removed payment_date from INSERT
-        query.prepare(R"(
+        auto insertPayment = statement(R"(
             INSERT INTO payments (receipt_no, learner_id, amount, processed_by, notes)
             VALUES (:receipt_no, :learner_id, :amount, :processed_by, :notes)
         )");
 
-        query.bindValue(":receipt_no", payment.getReceiptNo());
-        query.bindValue(":learner_id", payment.getLearnerId());
-        query.bindValue(":amount", payment.getAmount());
-        query.bindValue(":processed_by", payment.getProcessedBy());
-        query.bindValue(":notes", payment.getNotes());
+        insertPayment->bindValue(":receipt_no", payment.getReceiptNo());
+        insertPayment->bindValue(":learner_id", payment.getLearnerId());
+        insertPayment->bindValue(":amount", payment.getAmount());
+        insertPayment->bindValue(":processed_by", payment.getProcessedBy());
+        insertPayment->bindValue(":notes", payment.getNotes());
 
-        if (!query.exec()) {
-            throw std::runtime_error(query.lastError().text().toStdString());
+        if (!insertPayment->exec()) {
+            throw std::runtime_error(insertPayment->lastError().text().toStdString());
         }
 
-        int paymentId = query.lastInsertId().toInt();
+        int paymentId = insertPayment->lastInsertId().toInt();
         payment.setId(paymentId);
+        insertPayment.reset();
 
         // Set payment date to current timestamp from database
         payment.setPaymentDate(QDateTime::currentDateTime());
@@ -1355,46 +2214,46 @@ bool DatabaseManager::processPayment(Payments& payment, const QVector<int>& tran
             }
 
             // Insert payment item
-            query.prepare(R"(
+            auto insertItem = statement(R"(
                 INSERT INTO payment_items (payment_id, transaction_id, book_id, amount)
                 VALUES (:payment_id, :transaction_id, :book_id, :amount)
             )");
 
-            query.bindValue(":payment_id", paymentId);
-            query.bindValue(":transaction_id", transId);
-            query.bindValue(":book_id", trans.getBookId());
-            query.bindValue(":amount", book.getPrice());
+            insertItem->bindValue(":payment_id", paymentId);
+            insertItem->bindValue(":transaction_id", transId);
+            insertItem->bindValue(":book_id", trans.getBookId());
+            insertItem->bindValue(":amount", book.getPrice());
 
-            if (!query.exec()) {
-                throw std::runtime_error(query.lastError().text().toStdString());
+            if (!insertItem->exec()) {
+                throw std::runtime_error(insertItem->lastError().text().toStdString());
             }
 
             // Update transaction status to "Returned" (since payment is made for lost book)
             // Keep the status as "Lost" but we can add a note
-            query.prepare(R"(
+            auto markPaid = statement(R"(
                 UPDATE transactions
                 SET status = 'Paid'
                 WHERE id = :id
             )");
 
-            query.bindValue(":id", transId);
+            markPaid->bindValue(":id", transId);
 
-            if (!query.exec()) {
-                throw std::runtime_error(query.lastError().text().toStdString());
+            if (!markPaid->exec()) {
+                throw std::runtime_error(markPaid->lastError().text().toStdString());
             }
         }
 
         // Commit transaction
-        if (!m_database.commit()) {
+        if (!database().commit()) {
             throw std::runtime_error("Failed to commit transaction");
         }
 
+        publish(DomainEvent::Type::PaymentPosted, -1, payment.getLearnerId(), -1, paymentId);
         return true;
 
     } catch (const std::exception& e) {
-        m_database.rollback();
-        m_lastError = QString("Payment processing failed: %1").arg(e.what());
-        qDebug() << m_lastError;
+        database().rollback();
+        setLastError(QString("Payment processing failed: %1").arg(e.what()));
         return false;
     }
 
@@ -1402,43 +2261,26 @@ bool DatabaseManager::processPayment(Payments& payment, const QVector<int>& tran
 
 QVector<Transaction> DatabaseManager::getUnpaidLostTransactionsByLearnerId(int learnerId) {
     QVector<Transaction> transactions;
-    QSqlQuery query(m_database);
-
-    query.prepare(R"(
-        SELECT * FROM transactions
+    auto query = statement(QString(R"(
+        SELECT %1 FROM transactions
         WHERE learner_id = :learner_id
         AND status = 'Lost'
         ORDER BY return_date DESC
-    )");
+    )").arg(kTransactionColumns));
 
-    query.bindValue(":learner_id", learnerId);
+    query->bindValue(":learner_id", learnerId);
 
-    if (!query.exec()) {
-        qDebug() << "Error getting unpaid lost transactions:" << query.lastError().text();
+    if (!query->exec()) {
+        qDebug() << "Error getting unpaid lost transactions:" << query->lastError().text();
         return transactions;
     }
 
-    while (query.next()) {
-        Transaction trans;
-        trans.setId(query.value("id").toInt());
-        trans.setLearnerId(query.value("learner_id").toInt());
-        trans.setBookId(query.value("book_id").toInt());
-        trans.setBorrowDate(query.value("borrow_date").toDate());
-        trans.setDueDate(query.value("due_date").toDate());
-        trans.setReturnDate(query.value("return_date").toDate());
-        trans.setStatus(Transaction::stringToStatus(query.value("status").toString()));
-
-        transactions.append(trans);
-    }
-
-    return transactions;
+    return mapRows<Transaction>(*query);
 }
 
 double DatabaseManager::getTotalOutstandingFees(int learnerId) {
     double total = 0.0;
-    QSqlQuery query(m_database);
-
-    query.prepare(R"(
+    auto query = statement(R"(
         SELECT SUM(b.price) as total
         FROM transactions t
         JOIN books b ON t.book_id = b.id
@@ -1446,10 +2288,10 @@ double DatabaseManager::getTotalOutstandingFees(int learnerId) {
         AND t.status = 'Lost'
     )");
 
-    query.bindValue(":learner_id", learnerId);
+    query->bindValue(":learner_id", learnerId);
 
-    if (query.exec() && query.next()) {
-        total = query.value("total").toDouble();
+    if (query->exec() && query->next()) {
+        total = query->value("total").toDouble();
     }
 
     return total;
@@ -1457,19 +2299,11 @@ double DatabaseManager::getTotalOutstandingFees(int learnerId) {
 
 Payments DatabaseManager::getPaymentById(int id) {
     Payments payment;
-    QSqlQuery query(m_database);
-
-    query.prepare("SELECT * FROM payments WHERE id = :id");
-    query.bindValue(":id", id);
+    auto query = statement("SELECT " + kPaymentColumns + " FROM payments WHERE id = :id");
+    query->bindValue(":id", id);
 
-    if (query.exec() && query.next()) {
-        payment.setId(query.value("id").toInt());
-        payment.setReceiptNo(query.value("receipt_no").toString());
-        payment.setLearnerId(query.value("learner_id").toInt());
-        payment.setAmount(query.value("amount").toDouble());
-        payment.setProcessedBy(query.value("processed_by").toInt());
-        payment.setPaymentDate(query.value("payment_date").toDateTime());
-        payment.setNotes(query.value("notes").toString());
+    if (query->exec() && query->next()) {
+        payment = RowMapper<Payments>::map(*query);
     }
 
     return payment;
@@ -1477,59 +2311,33 @@ Payments DatabaseManager::getPaymentById(int id) {
 
 QVector<Payments> DatabaseManager::getPaymentsByLearnerId(int learnerId) {
     QVector<Payments> payments;
-    QSqlQuery query(m_database);
-
-    query.prepare(R"(
-        SELECT * FROM payments
+    auto query = statement(QString(R"(
+        SELECT %1 FROM payments
         WHERE learner_id = :learner_id
         ORDER BY payment_date DESC
-    )");
+    )").arg(kPaymentColumns));
 
-    query.bindValue(":learner_id", learnerId);
+    query->bindValue(":learner_id", learnerId);
 
-    if (!query.exec()) {
-        qDebug() << "Error getting payments:" << query.lastError().text();
+    if (!query->exec()) {
+        qDebug() << "Error getting payments:" << query->lastError().text();
         return payments;
     }
 
-    while (query.next()) {
-        Payments payment;
-        payment.setId(query.value("id").toInt());
-        payment.setReceiptNo(query.value("receipt_no").toString());
-        payment.setLearnerId(query.value("learner_id").toInt());
-        payment.setAmount(query.value("amount").toDouble());
-        payment.setProcessedBy(query.value("processed_by").toInt());
-        payment.setPaymentDate(query.value("payment_date").toDateTime());
-        payment.setNotes(query.value("notes").toString());
-        payments.append(payment);
-    }
-
-    return payments;
+    return mapRows<Payments>(*query);
 }
 
 QVector<PaymentItem> DatabaseManager::getPaymentItems(int paymentId) {
     QVector<PaymentItem> items;
-    QSqlQuery query(m_database);
+    auto query = statement("SELECT " + kPaymentItemColumns + " FROM payment_items WHERE payment_id = :payment_id");
+    query->bindValue(":payment_id", paymentId);
 
-    query.prepare("SELECT * FROM payment_items WHERE payment_id = :payment_id");
-    query.bindValue(":payment_id", paymentId);
-
-    if (!query.exec()) {
-        qDebug() << "Error getting payment items:" << query.lastError().text();
+    if (!query->exec()) {
+        qDebug() << "Error getting payment items:" << query->lastError().text();
         return items;
     }
 
-    while (query.next()) {
-        PaymentItem item;
-        item.setId(query.value("id").toInt());
-        item.setPaymentId(query.value("payment_id").toInt());
-        item.setTransactionId(query.value("transaction_id").toInt());
-        item.setBookId(query.value("book_id").toInt());
-        item.setAmount(query.value("amount").toDouble());
-        items.append(item);
-    }
-
-    return items;
+    return mapRows<PaymentItem>(*query);
 }
 
 
@@ -1541,12 +2349,11 @@ QVector<PaymentItem> DatabaseManager::getPaymentItems(int paymentId) {
 // ============================================================================
 
 QDateTime DatabaseManager::getUserLastLogin(int userId) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT last_login FROM users WHERE id = :id");
-    query.bindValue(":id", userId);
+    auto query = statement("SELECT last_login FROM users WHERE id = :id");
+    query->bindValue(":id", userId);
 
-    if (query.exec() && query.next()) {
-        return query.value(0).toDateTime();
+    if (query->exec() && query->next()) {
+        return query->value(0).toDateTime();
     }
 
     return QDateTime(); // Invalid datetime
@@ -1557,12 +2364,11 @@ QDateTime DatabaseManager::getUserLastLogin(int userId) {
 // ============================================================================
 
 QDateTime DatabaseManager::getPasswordChangedDate(int userId) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT password_changed_at FROM users WHERE id = :id");
-    query.bindValue(":id", userId);
+    auto query = statement("SELECT password_changed_at FROM users WHERE id = :id");
+    query->bindValue(":id", userId);
 
-    if (query.exec() && query.next()) {
-        return query.value(0).toDateTime();
+    if (query->exec() && query->next()) {
+        return query->value(0).toDateTime();
     }
 
     return QDateTime(); // Invalid datetime
@@ -1574,25 +2380,24 @@ QDateTime DatabaseManager::getPasswordChangedDate(int userId) {
 // ============================================================================
 
 bool DatabaseManager::changeUserPassword(int userId, const QString& newPassword) {
-    QSqlQuery query(m_database);
-
     // Hash the new password
     QString hashedPassword = Encryption::hashPassword(newPassword);
 
-    query.prepare(R"(
+    auto query = statement(R"(
         UPDATE users
         SET password_hash = :password,
             password_changed_at = :changed_at
         WHERE id = :id
     )");
 
-    query.bindValue(":password", hashedPassword);
-    query.bindValue(":changed_at", QDateTime::currentDateTime());
-    query.bindValue(":id", userId);
+    query->bindValue(":password", hashedPassword);
+    query->bindValue(":changed_at", QDateTime::currentDateTime());
+    query->bindValue(":id", userId);
 
-    if (!query.exec()) {
-        m_lastError = "Failed to change password: " + query.lastError().text();
-        qWarning() << m_lastError;
+    bool ok = query->exec();
+    m_userCache.remove(userId);
+    if (!ok) {
+        setLastError("Failed to change password: " + query->lastError().text());
         return false;
     }
 
@@ -1605,21 +2410,39 @@ bool DatabaseManager::changeUserPassword(int userId, const QString& newPassword)
 
 bool DatabaseManager::logUserActivity(int userId, const QString& actionType,
                                       const QString& actionDetails) {
-    QSqlQuery query(m_database);
+    return ActivityLogger::instance().log(userId, actionType, actionDetails);
+}
+
+// One transaction per batch: a single commit (and fsync) for the lot
+bool DatabaseManager::writeActivityLogs(const QVector<UserActivityLog>& entries) {
+    if (!database().transaction()) {
+        setLastError("Failed to start database transaction");
+        return false;
+    }
 
-    query.prepare(R"(
+    auto query = statement(R"(
         INSERT INTO user_activity_logs (user_id, action_type, action_details, created_at)
         VALUES (:user_id, :action_type, :action_details, :created_at)
     )");
 
-    query.bindValue(":user_id", userId);
-    query.bindValue(":action_type", actionType);
-    query.bindValue(":action_details", actionDetails);
-    query.bindValue(":created_at", QDateTime::currentDateTime());
+    for (const UserActivityLog& entry : entries) {
+        query->bindValue(":user_id", entry.userId);
+        query->bindValue(":action_type", entry.actionType);
+        query->bindValue(":action_details", entry.actionDetails);
+        query->bindValue(":created_at", entry.createdAt);
+
+        if (!query->exec()) {
+            setLastError("Failed to log activity: " + query->lastError().text());
+            query.reset();
+            database().rollback();
+            return false;
+        }
+    }
+    query.reset();
 
-    if (!query.exec()) {
-        m_lastError = "Failed to log activity: " + query.lastError().text();
-        qWarning() << m_lastError;
+    if (!database().commit()) {
+        setLastError("Failed to commit activity log: " + database().lastError().text());
+        database().rollback();
         return false;
     }
 
@@ -1631,37 +2454,311 @@ bool DatabaseManager::logUserActivity(int userId, const QString& actionType,
 // ============================================================================
 
 QVector<UserActivityLog> DatabaseManager::getUserActivityLog(int userId, int limit) {
+    return getUserActivityLog(userId, QDateTime(), QDateTime(), limit);
+}
+
+// Newest first. The live table is read first, then only the monthly
+// partitions the range overlaps, newest month first, until limit rows are in.
+QVector<UserActivityLog> DatabaseManager::getUserActivityLog(int userId, const QDateTime& from,
+                                                             const QDateTime& to, int limit) {
+    // Include entries still waiting in the logger's queue
+    ActivityLogger::instance().flush();
+
     QVector<UserActivityLog> logs;
-    QSqlQuery query(m_database);
+    if (!readActivityRows("user_activity_logs", userId, from, to, limit, logs)) {
+        return logs;
+    }
+
+    QVector<QPair<QString, bool>> partitions;
+    {
+        auto query = statement(R"(
+            SELECT period, compressed_rows IS NOT NULL FROM activity_log_partitions
+            WHERE period >= :from_period AND period <= :to_period
+            ORDER BY period DESC
+        )");
+        query->bindValue(":from_period", from.isValid() ? from.toString("yyyy-MM") : QString("0000-00"));
+        query->bindValue(":to_period", to.isValid() ? to.toString("yyyy-MM") : QString("9999-99"));
+        if (!executeQuery(*query)) {
+            return logs;
+        }
+        while (query->next()) {
+            partitions.append({ query->value(0).toString(), query->value(1).toBool() });
+        }
+    }
+
+    for (const auto& partition : partitions) {
+        if (logs.size() >= limit) {
+            break;
+        }
+        if (!partition.second) {
+            if (!readActivityRows(activityPartitionTable(partition.first), userId, from, to,
+                                  limit - logs.size(), logs)) {
+                break;
+            }
+            continue;
+        }
+
+        auto query = statement("SELECT compressed_rows FROM activity_log_partitions WHERE period = :period");
+        query->bindValue(":period", partition.first);
+        if (!executeQuery(*query) || !query->next()) {
+            break;
+        }
+        QVector<UserActivityLog> rows = unpackActivityRows(query->value(0).toByteArray());
+        for (int i = rows.size() - 1; i >= 0 && logs.size() < limit; --i) {
+            const UserActivityLog& row = rows.at(i);
+            if (row.userId == userId && (!from.isValid() || row.createdAt >= from)
+                && (!to.isValid() || row.createdAt < to)) {
+                logs.append(row);
+            }
+        }
+    }
 
-    query.prepare(R"(
+    // A late entry can reach the live table after its month was rolled
+    std::stable_sort(logs.begin(), logs.end(), [](const UserActivityLog& a, const UserActivityLog& b) {
+        return a.createdAt > b.createdAt;
+    });
+    return logs;
+}
+
+bool DatabaseManager::readActivityRows(const QString& table, int userId, const QDateTime& from,
+                                       const QDateTime& to, int limit, QVector<UserActivityLog>& logs) {
+    // Seeks the (user_id, created_at) index and reads it backwards
+    auto query = statement(R"(
         SELECT id, user_id, action_type, action_details, created_at
-        FROM user_activity_logs
-        WHERE user_id = :user_id
+        FROM )" + table + R"(
+        WHERE user_id = :user_id AND created_at >= :from AND created_at < :to
         ORDER BY created_at DESC
         LIMIT :limit
     )");
 
-    query.bindValue(":user_id", userId);
-    query.bindValue(":limit", limit);
+    query->bindValue(":user_id", userId);
+    query->bindValue(":from", from.isValid() ? from.toString(Qt::ISODateWithMs) : QString(""));
+    query->bindValue(":to", to.isValid() ? to.toString(Qt::ISODateWithMs) : QString("9999"));
+    query->bindValue(":limit", limit);
 
-    if (!query.exec()) {
-        m_lastError = "Failed to get activity log: " + query.lastError().text();
-        qWarning() << m_lastError;
-        return logs;
+    if (!query->exec()) {
+        setLastError("Failed to get activity log: " + query->lastError().text());
+        return false;
     }
 
-    while (query.next()) {
+    while (query->next()) {
+        UserActivityLog log;
+        log.id = query->value(0).toInt();
+        log.userId = query->value(1).toInt();
+        log.actionType = query->value(2).toString();
+        log.actionDetails = query->value(3).toString();
+        log.createdAt = query->value(4).toDateTime();
+
+        logs.append(log);
+    }
+
+    return true;
+}
+
+// ==================== Activity Log Partitions ====================
+
+int DatabaseManager::rollActivityLogPartitions(const QDate& today, int keepMonths) {
+    const QDate liveStart(today.year(), today.month(), 1);
+
+    QStringList periods;
+    {
+        auto query = statement(R"(
+            SELECT DISTINCT substr(created_at, 1, 7) FROM user_activity_logs
+            WHERE created_at < :live_start
+        )");
+        query->bindValue(":live_start", liveStart.toString("yyyy-MM-dd"));
+        if (!executeQuery(*query)) {
+            return -1;
+        }
+        while (query->next()) {
+            periods << query->value(0).toString();
+        }
+    }
+
+    int changed = 0;
+    for (const QString& period : periods) {
+        if (!moveActivityMonth(period)) {
+            return -1;
+        }
+        ++changed;
+    }
+
+    if (keepMonths <= 0) {
+        return changed;
+    }
+
+    periods.clear();
+    {
+        auto query = statement(R"(
+            SELECT period FROM activity_log_partitions
+            WHERE compressed_rows IS NULL AND period < :cutoff
+        )");
+        query->bindValue(":cutoff", liveStart.addMonths(-keepMonths).toString("yyyy-MM"));
+        if (!executeQuery(*query)) {
+            return -1;
+        }
+        while (query->next()) {
+            periods << query->value(0).toString();
+        }
+    }
+
+    for (const QString& period : periods) {
+        if (!compressActivityMonth(period)) {
+            return -1;
+        }
+        ++changed;
+    }
+
+    qDebug() << "Rolled" << changed << "activity log partitions";
+    return changed;
+}
+
+// Moves one closed month ('yyyy-MM') out of the live table in a single transaction
+bool DatabaseManager::moveActivityMonth(const QString& period) {
+    const QString table = activityPartitionTable(period);
+    if (table.isEmpty()) {
+        setLastError("Unexpected activity log period " + period);
+        return false;
+    }
+    const QDate monthStart = QDate::fromString(period + "-01", "yyyy-MM-dd");
+
+    if (!database().transaction()) {
+        setLastError("Failed to start database transaction");
+        return false;
+    }
+
+    QSqlQuery query(database());
+    bool ok = query.exec("CREATE TABLE IF NOT EXISTS " + table + R"( (
+                              id INTEGER PRIMARY KEY,
+                              user_id INTEGER NOT NULL,
+                              action_type TEXT NOT NULL,
+                              action_details TEXT,
+                              created_at DATETIME
+                          ))")
+              && query.exec("CREATE INDEX IF NOT EXISTS idx_" + table + "_user_created ON " + table +
+                            "(user_id, created_at)");
+
+    // A month that was already compressed is unpacked again so late entries join it
+    QByteArray packed;
+    if (ok) {
+        query.prepare("SELECT compressed_rows FROM activity_log_partitions WHERE period = :period");
+        query.bindValue(":period", period);
+        ok = query.exec();
+        if (ok && query.next()) {
+            packed = query.value(0).toByteArray();
+        }
+        query.finish();
+    }
+    if (ok && !packed.isEmpty()) {
+        query.prepare("INSERT OR IGNORE INTO " + table +
+                      " (id, user_id, action_type, action_details, created_at) VALUES (?, ?, ?, ?, ?)");
+        const QVector<UserActivityLog> rows = unpackActivityRows(packed);
+        for (int i = 0; ok && i < rows.size(); ++i) {
+            query.bindValue(0, rows.at(i).id);
+            query.bindValue(1, rows.at(i).userId);
+            query.bindValue(2, rows.at(i).actionType);
+            query.bindValue(3, rows.at(i).actionDetails);
+            query.bindValue(4, rows.at(i).createdAt);
+            ok = query.exec();
+        }
+    }
+
+    if (ok) {
+        query.prepare("INSERT OR IGNORE INTO " + table + R"(
+                          SELECT id, user_id, action_type, action_details, created_at FROM user_activity_logs
+                          WHERE created_at >= :month_start AND created_at < :month_end
+                      )");
+        query.bindValue(":month_start", monthStart.toString("yyyy-MM-dd"));
+        query.bindValue(":month_end", monthStart.addMonths(1).toString("yyyy-MM-dd"));
+        ok = query.exec();
+    }
+    if (ok) {
+        query.prepare(R"(
+            DELETE FROM user_activity_logs
+            WHERE created_at >= :month_start AND created_at < :month_end
+        )");
+        query.bindValue(":month_start", monthStart.toString("yyyy-MM-dd"));
+        query.bindValue(":month_end", monthStart.addMonths(1).toString("yyyy-MM-dd"));
+        ok = query.exec();
+    }
+    if (ok) {
+        query.prepare("INSERT INTO activity_log_partitions (period, row_count, compressed_rows)"
+                      " VALUES (:period, (SELECT COUNT(*) FROM " + table + "), NULL)"
+                      " ON CONFLICT(period) DO UPDATE SET"
+                      " row_count = excluded.row_count, compressed_rows = NULL");
+        query.bindValue(":period", period);
+        ok = query.exec();
+    }
+
+    if (!ok) {
+        setLastError("Failed to move activity log month " + period + ": " + query.lastError().text());
+        query.finish();
+        database().rollback();
+        return false;
+    }
+    query.finish();
+
+    if (!database().commit()) {
+        setLastError("Failed to commit activity log month " + period + ": " + database().lastError().text());
+        database().rollback();
+        return false;
+    }
+    return true;
+}
+
+// Packs a month's table into one compressed blob and drops the table
+bool DatabaseManager::compressActivityMonth(const QString& period) {
+    const QString table = activityPartitionTable(period);
+    if (table.isEmpty()) {
+        setLastError("Unexpected activity log period " + period);
+        return false;
+    }
+
+    if (!database().transaction()) {
+        setLastError("Failed to start database transaction");
+        return false;
+    }
+
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    QVector<UserActivityLog> rows;
+    bool ok = query.exec("SELECT id, user_id, action_type, action_details, created_at FROM " + table +
+                         " ORDER BY created_at, id");
+    while (ok && query.next()) {
         UserActivityLog log;
         log.id = query.value(0).toInt();
         log.userId = query.value(1).toInt();
         log.actionType = query.value(2).toString();
         log.actionDetails = query.value(3).toString();
         log.createdAt = query.value(4).toDateTime();
+        rows.append(log);
+    }
+    query.finish();
 
-        logs.append(log);
+    if (ok) {
+        query.prepare(R"(
+            UPDATE activity_log_partitions SET row_count = :row_count, compressed_rows = :rows
+            WHERE period = :period
+        )");
+        query.bindValue(":row_count", rows.size());
+        query.bindValue(":rows", packActivityRows(rows));
+        query.bindValue(":period", period);
+        ok = query.exec() && query.exec("DROP TABLE " + table);
     }
 
-    return logs;
+    if (!ok) {
+        setLastError("Failed to compress activity log month " + period + ": " + query.lastError().text());
+        query.finish();
+        database().rollback();
+        return false;
+    }
+    query.finish();
+
+    if (!database().commit()) {
+        setLastError("Failed to commit activity log month " + period + ": " + database().lastError().text());
+        database().rollback();
+        return false;
+    }
+    return true;
 }
 
@@ -5,23 +5,37 @@
 #include <QSqlQuery>
 #include <QString>
 #include <QVector>
+#include <QHash>
 #include <QDate>
+#include <QMutex>
+#include <QAtomicInt>
 #include "User.h"
 #include "Learner.h"
 #include "Book.h"
 #include "Transaction.h"
 #include "Payments.h"
 #include "PaymentItem.h"
+#include "StatementCache.h"
+#include "ConnectionPool.h"
+#include "Pagination.h"
+#include "StorageProfile.h"
+#include "LruCache.h"
 
 class DatabaseManager {
 public:
     static DatabaseManager& instance();
-    QSqlDatabase& getDatabase() { return m_database; }
+    // Connection for the calling thread; each thread gets its own
+    QSqlDatabase getDatabase() { return database(); }
 
     // Database initialization
-    bool initialize(const QString& dbPath = "library_system.db");
-    bool createTables();
+    bool initialize(const QString& dbPath = "library_system.db",
+                    const StorageProfile& profile = StorageProfile::deskLaptop());
+    bool migrateSchema();
     void closeDatabase();
+
+    // Storage tuning; the profile is fixed by initialize() for the session
+    StorageProfile getStorageProfile() const;
+    bool checkpoint(StorageProfile::Checkpoint mode = StorageProfile::Checkpoint::Passive);
     
     // User operations
     bool addUser(const User& user);
@@ -31,23 +45,44 @@ public:
     User getUserByUsername(const QString& username);
     User getUserByEmail(const QString& email);
     QVector<User> getAllUsers();
+    QVector<UserListRow> getUserList();    // Listing columns only, no credentials
+    Page<UserListRow> getUsersPage(const PageCursor& after = PageCursor(), int limit = 200);
     bool userExists(const QString& username);
     QDateTime getUserLastLogin(int userId);
     QDateTime getPasswordChangedDate(int userId);
     bool changeUserPassword(int userId, const QString& newPassword);
 
-    // Activity Logging
+    // Activity Logging: logUserActivity() only queues the entry with
+    // ActivityLogger, whose writer commits batches through writeActivityLogs()
     bool logUserActivity(int userId, const QString& actionType, const QString& actionDetails);
+    bool writeActivityLogs(const QVector<UserActivityLog>& entries);
     QVector<UserActivityLog> getUserActivityLog(int userId, int limit = 100);
+    // Entries in [from, to); an invalid bound leaves that side open
+    QVector<UserActivityLog> getUserActivityLog(int userId, const QDateTime& from, const QDateTime& to,
+                                                int limit = 100);
+
+    // The live user_activity_logs table keeps the current month. Earlier months
+    // move to user_activity_logs_yyyyMM tables, and those more than keepMonths
+    // back are packed into one compressed row each (0 keeps them as tables).
+    // Returns the number of months moved or packed, or -1 on error.
+    int rollActivityLogPartitions(const QDate& today, int keepMonths);
     
     // Learner operations
     bool addLearner(const Learner& learner);
     bool updateLearner(const Learner& learner);
     bool deleteLearner(int learnerId);
     Learner getLearnerById(int learnerId);
+    QHash<int, Learner> getLearnersByIds(const QVector<int>& learnerIds);    // Missing ids are absent
     QVector<Learner> getAllLearners();
+    enum class LearnerSort { Surname, GradeSurname };
+    // A non-empty grade lists only that grade
+    Page<Learner> getLearnersPage(LearnerSort sort, const PageCursor& after = PageCursor(), int limit = 200,
+                                  const QString& grade = QString());
     QVector<Learner> getLearnersByGrade(const QString& grade);
-    QVector<Learner> searchLearners(const QString& searchTerm);
+    // Full-text (FTS5) prefix search ranked by BM25; falls back to LIKE without FTS5
+    QVector<Learner> searchLearners(const QString& searchTerm, int limit = 500);
+    Page<Learner> searchLearnersPage(const QString& searchTerm, const PageCursor& after = PageCursor(),
+                                     int limit = 200);
     int getLearnerCount();
     int getActiveLearnerCount(); // Learners with active borrows
     
@@ -56,12 +91,19 @@ public:
     bool updateBook(const Book& book);
     bool deleteBook(int bookId);
     Book getBookById(int bookId);
+    QHash<int, Book> getBooksByIds(const QVector<int>& bookIds);    // Missing ids are absent
     Book getBookByCode(const QString& bookCode);
     QVector<Book> getAllBooks();
+    enum class BookSort { Title, Author, GradeTitle, SubjectTitle };
+    // A non-empty grade lists only that grade
+    Page<BookListRow> getBooksPage(BookSort sort, const PageCursor& after = PageCursor(), int limit = 200,
+                                   const QString& grade = QString());
     QVector<Book> getBooksByGrade(const QString& grade);
     QVector<Book> getBooksBySubject(const QString& subject);
     QVector<Book> getBooksByStatus(Book::Status status);
-    QVector<Book> searchBooks(const QString& searchTerm);
+    QVector<Book> searchBooks(const QString& searchTerm, int limit = 500);
+    Page<BookListRow> searchBooksPage(const QString& searchTerm, const PageCursor& after = PageCursor(),
+                                      int limit = 200);
     bool bookCodeExists(const QString& bookCode);
     int getBookCountByISBN(const QString& isbn);
     int getTotalBookCount();
@@ -69,16 +111,43 @@ public:
     int getBorrowedBookCount();
     
     // Transaction operations
+    // Current reads only the live table (every Active and Lost loan plus closed
+    // loans newer than the last archive run); Full also reads the archive
+    enum class HistoryScope { Current, Full };
+
     bool addTransaction(const Transaction& transaction);
     bool updateTransaction(const Transaction& transaction);
-    Transaction getTransactionById(int transactionId);
-    QVector<Transaction> getTransactionsByLearnerId(int learnerId);
+    Transaction getTransactionById(int transactionId, HistoryScope scope = HistoryScope::Current);
+    QVector<Transaction> getTransactionsByLearnerId(int learnerId, HistoryScope scope = HistoryScope::Current);
     QVector<Transaction> getActiveTransactionsByLearnerId(int learnerId);
-    QVector<Transaction> getTransactionsByBookId(int bookId);
-    QVector<Transaction> getAllTransactions();
+    QVector<Transaction> getTransactionsByBookId(int bookId, HistoryScope scope = HistoryScope::Current);
+    QVector<Transaction> getAllTransactions(HistoryScope scope = HistoryScope::Current);
+    // Newest first; learnerId >= 0 restricts to one learner's history
+    Page<Transaction> getTransactionsPage(const PageCursor& after = PageCursor(), int limit = 200,
+                                          int learnerId = -1, HistoryScope scope = HistoryScope::Current);
     QVector<Transaction> getActiveTransactions();
     QVector<Transaction> getOverdueTransactions();
-    QVector<Transaction> getTransactionsByDateRange(const QDate& startDate, const QDate& endDate);
+    QVector<Transaction> getTransactionsByDateRange(const QDate& startDate, const QDate& endDate,
+                                                    HistoryScope scope = HistoryScope::Current);
+
+    // Transactions joined with book code/title/price and learner name, one query each
+    QVector<TransactionDetail> getTransactionDetailsByLearner(int learnerId,
+                                                              HistoryScope scope = HistoryScope::Current);
+    QVector<TransactionDetail> getActiveTransactionDetailsByLearner(int learnerId);
+    QVector<TransactionDetail> getActiveTransactionDetailsByBookCode(const QString& bookCode);
+    QVector<TransactionDetail> getUnpaidLostTransactionDetails(int learnerId);
+    QVector<TransactionDetail> getRecentTransactionDetails(int limit = 10);
+    Page<TransactionDetail> getTransactionDetailsPage(const PageCursor& after = PageCursor(), int limit = 200,
+                                                      int learnerId = -1,
+                                                      HistoryScope scope = HistoryScope::Current);
+
+    // Year-end archiving: moves Returned and Paid loans closed before the
+    // cut-off into the attached archive database, batchSize rows per short
+    // write transaction. Returns the number moved, or -1 on error.
+    int archiveClosedTransactions(const QDate& closedBefore, int batchSize = 500);
+    QString archiveDatabasePath() const;
+    // library_system.db -> library_system-archive.db next to it
+    static QString archivePathFor(const QString& dbPath);
     
     // Business logic operations
     bool borrowBook(int learnerId, int bookId, const QDate& borrowDate);
@@ -86,23 +155,49 @@ public:
     bool markBookAsLost(int transactionId);
     bool hasOverdueBooks(int learnerId);
     double calculateUnreturnedBooksAmount(int learnerId);
+
+    // Bulk issuing (e.g. class sets on distribution day). Eligibility is checked
+    // for the whole batch up front; loans are written in transactions of
+    // chunkSize. Results are in request order.
+    struct BorrowRequest {
+        int learnerId;
+        int bookId;
+    };
+    struct BorrowResult {
+        int learnerId = -1;
+        int bookId = -1;
+        int transactionId = -1;
+        bool success = false;
+        QString error;
+    };
+    QVector<BorrowResult> borrowBooksBatch(const QVector<BorrowRequest>& requests, const QDate& borrowDate,
+                                           int chunkSize = 500);
+
+    // Returns scanned copies by book code, all in one transaction. Results are
+    // in scan order; a code with no active loan is rejected, not an error.
+    struct ScanReturnResult {
+        QString bookCode;
+        int transactionId = -1;
+        int bookId = -1;
+        bool accepted = false;
+        QString error;
+    };
+    QVector<ScanReturnResult> returnBooksByCodes(const QStringList& bookCodes, const QDate& returnDate);
     
     // Dashboard statistics
+    // Served from LibraryStatistics' in-memory counters
     struct DashboardStats {
-        int totalBooks;
-        int availableBooks;
-        int borrowedBooks;
-        int totalLearners;
-        int activeLearners;
-        int totalUsers;
-        int overdueBooks;
+        int totalBooks = 0;
+        int availableBooks = 0;
+        int borrowedBooks = 0;
+        int lostBooks = 0;
+        int totalLearners = 0;
+        int activeLearners = 0;
+        int totalUsers = 0;
+        int overdueBooks = 0;
     };
     DashboardStats getDashboardStats();
 
-    //Payments
-    // Create payment tables
-    bool createPaymentTables();
-
     // Payment operations
     bool processPayment(Payments& payment, const QVector<int>& transactionIds);
     Payments getPaymentById(int id);
@@ -121,7 +216,22 @@ public:
     QVector<Transaction> getRecentTransactions(int limit = 10);
     
     // Error handling
-    QString getLastError() const { return m_lastError; }
+    // Last error raised on the calling thread
+    QString getLastError() const;
+
+    // Prepared statement cache diagnostics
+    StatementCache::Stats getStatementCacheStats() const;
+
+    // LRU cache behind getBookById, getLearnerById and getUserById
+    static constexpr int kDefaultEntityCacheCapacity = 500;
+    struct EntityCacheStats {
+        LruCacheStats books;
+        LruCacheStats learners;
+        LruCacheStats users;
+    };
+    void setEntityCacheCapacity(int entries);    // Per entity type; 0 disables caching
+    void clearEntityCaches();
+    EntityCacheStats getEntityCacheStats() const;
     
 private:
     DatabaseManager();
@@ -129,12 +239,32 @@ private:
     DatabaseManager(const DatabaseManager&) = delete;
     DatabaseManager& operator=(const DatabaseManager&) = delete;
     
-    QSqlDatabase m_database;
-    QString m_lastError;
+    ConnectionPool m_pool;
+    mutable QMutex m_profileMutex;
+    StorageProfile m_storageProfile;
+    QAtomicInt m_fullTextSearch;    // -1 unknown, 0 unavailable, 1 available
+    LruCache<int, Book> m_bookCache;
+    LruCache<int, Learner> m_learnerCache;
+    LruCache<int, User> m_userCache;
     
     // Helper methods
     void setLastError(const QString& error);
     bool executeQuery(QSqlQuery& query);
+    PreparedStatement statement(const QString& sql);
+    // COUNT(*) for Page::estimatedTotal, with one bound value; -1 on failure
+    int estimateRows(const QString& sql, const QString& placeholder = QString(), const QVariant& value = QVariant());
+    QSqlDatabase database();
+    bool hasFullTextSearch();
+    bool configureConnection(QSqlDatabase& database, QString& error);
+    static bool applyStorageProfile(QSqlDatabase& database, const StorageProfile& profile,
+                                    QString& error);
+    static void attachArchive(QSqlDatabase& database, const StorageProfile& profile);
+    bool closeTransaction(int transactionId, Transaction::Status transactionStatus,
+                          Book::Status bookStatus, const QDate& returnDate);
+    bool readActivityRows(const QString& table, int userId, const QDateTime& from, const QDateTime& to,
+                          int limit, QVector<UserActivityLog>& logs);
+    bool moveActivityMonth(const QString& period);
+    bool compressActivityMonth(const QString& period);
 };
 
 #endif // DATABASEMANAGER_H
@@ -0,0 +1,95 @@
+#include "DomainEvents.h"
+#include <QCoreApplication>
+#include <QMutexLocker>
+
+bool DomainChanges::contains(DomainEvent::Type type) const {
+    for (const DomainEvent& event : events) {
+        if (event.type == type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+DomainEvents& DomainEvents::instance() {
+    static DomainEvents instance;
+    return instance;
+}
+
+DomainEvents::DomainEvents()
+    : m_scheduled(false)
+{
+    // The first publisher may be a worker; deliveries belong on the GUI thread
+    if (QCoreApplication::instance()) {
+        moveToThread(QCoreApplication::instance()->thread());
+    }
+}
+
+void DomainEvents::publish(const DomainEvent& event) {
+    QMutexLocker locker(&m_mutex);
+    m_pending.append(event);
+    if (m_scheduled) {
+        return;
+    }
+    m_scheduled = true;
+    QMetaObject::invokeMethod(this, &DomainEvents::deliver, Qt::QueuedConnection);
+}
+
+void DomainEvents::deliver() {
+    QVector<DomainEvent> pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        pending.swap(m_pending);
+        m_scheduled = false;
+    }
+
+    // A class-set issue publishes thousands of loans in one pass
+    DomainChanges changes;
+    QSet<DomainEvent> seen;
+    seen.reserve(pending.size());
+    for (const DomainEvent& event : pending) {
+        if (seen.contains(event)) {
+            continue;
+        }
+        seen.insert(event);
+        changes.events.append(event);
+
+        switch (event.type) {
+            case DomainEvent::Type::BookAdded:
+                changes.addedBooks.insert(event.bookId);
+                break;
+            case DomainEvent::Type::BookDeleted:
+                changes.deletedBooks.insert(event.bookId);
+                break;
+            case DomainEvent::Type::BookUpdated:
+                changes.changedBooks.insert(event.bookId);
+                break;
+            case DomainEvent::Type::BookBorrowed:
+            case DomainEvent::Type::BookReturned:
+            case DomainEvent::Type::BookLost:
+                changes.changedBooks.insert(event.bookId);
+                changes.changedLearners.insert(event.learnerId);
+                break;
+            case DomainEvent::Type::LearnerAdded:
+                changes.addedLearners.insert(event.learnerId);
+                break;
+            case DomainEvent::Type::LearnerUpdated:
+            case DomainEvent::Type::PaymentPosted:
+                changes.changedLearners.insert(event.learnerId);
+                break;
+            case DomainEvent::Type::LearnerDeleted:
+                changes.deletedLearners.insert(event.learnerId);
+                break;
+        }
+    }
+
+    // A row added or deleted in the same pass needs no separate refresh
+    changes.changedBooks -= changes.addedBooks;
+    changes.changedBooks -= changes.deletedBooks;
+    changes.changedLearners -= changes.addedLearners;
+    changes.changedLearners -= changes.deletedLearners;
+    changes.changedBooks.remove(-1);
+    changes.changedLearners.remove(-1);
+
+    emit changed(changes);
+}
@@ -0,0 +1,83 @@
+#ifndef DOMAINEVENTS_H
+#define DOMAINEVENTS_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QVector>
+
+// Something DatabaseManager committed. Ids that do not apply stay -1.
+struct DomainEvent {
+    enum class Type {
+        BookAdded,
+        BookUpdated,
+        BookDeleted,
+        BookBorrowed,
+        BookReturned,
+        BookLost,
+        LearnerAdded,
+        LearnerUpdated,
+        LearnerDeleted,
+        PaymentPosted
+    };
+
+    Type type = Type::BookUpdated;
+    int bookId = -1;
+    int learnerId = -1;
+    int transactionId = -1;
+    int paymentId = -1;
+
+    bool operator==(const DomainEvent& other) const {
+        return type == other.type && bookId == other.bookId && learnerId == other.learnerId
+               && transactionId == other.transactionId && paymentId == other.paymentId;
+    }
+};
+
+// Lets a pass drop duplicates through a QSet instead of scanning its events
+inline size_t qHash(const DomainEvent& event, size_t seed = 0) noexcept {
+    return qHashMulti(seed, int(event.type), event.bookId, event.learnerId, event.transactionId,
+                      event.paymentId);
+}
+
+// Everything published during one pass of the event loop, duplicates
+// dropped, with the ids sorted by what a table has to do about them
+struct DomainChanges {
+    QVector<DomainEvent> events;
+    QSet<int> addedBooks;
+    QSet<int> changedBooks;      // Edited, or its status moved with a loan
+    QSet<int> deletedBooks;
+    QSet<int> addedLearners;
+    QSet<int> changedLearners;   // Edited, or a loan or payment of theirs changed
+    QSet<int> deletedLearners;
+
+    bool contains(DomainEvent::Type type) const;
+};
+
+// In-process bus for committed changes. publish() may be called from any
+// thread; subscribers connect to changed() and get one coalesced batch per
+// event-loop pass, on the GUI thread.
+class DomainEvents : public QObject {
+    Q_OBJECT
+
+public:
+    static DomainEvents& instance();
+
+    void publish(const DomainEvent& event);
+
+signals:
+    void changed(const DomainChanges& changes);
+
+private:
+    DomainEvents();
+    DomainEvents(const DomainEvents&) = delete;
+    DomainEvents& operator=(const DomainEvents&) = delete;
+
+    void deliver();
+
+    QMutex m_mutex;
+    QVector<DomainEvent> m_pending;
+    bool m_scheduled;
+};
+
+#endif // DOMAINEVENTS_H
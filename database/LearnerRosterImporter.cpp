@@ -0,0 +1,378 @@
+#include "LearnerRosterImporter.h"
+#include "DatabaseManager.h"
+#include "CsvReader.h"
+#include "LibraryStatistics.h"
+#include <QDate>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSqlError>
+
+namespace {
+
+// SQLite's default host-parameter limit in older builds
+constexpr int kMaxBoundValues = 999;
+
+// Rosters come out of spreadsheets, so the common day-first forms are accepted too
+QDate parseDate(const QString& text) {
+    static const char* const formats[] = { "yyyy-MM-dd", "yyyy/MM/dd", "dd/MM/yyyy", "d/M/yyyy", "dd-MM-yyyy" };
+    for (const char* format : formats) {
+        QDate date = QDate::fromString(text, format);
+        if (date.isValid()) {
+            return date;
+        }
+    }
+    return QDate();
+}
+
+QString naturalKey(const QString& name, const QString& surname, const QString& dateOfBirth) {
+    return surname.toLower() + '\x1f' + name.toLower() + '\x1f' + dateOfBirth;
+}
+
+}
+
+LearnerRosterImporter::ColumnMapping LearnerRosterImporter::ColumnMapping::fromHeader(const QStringList& header) {
+    ColumnMapping mapping;
+    for (int i = 0; i < header.size(); ++i) {
+        QString key = CsvReader::headerKey(header.at(i));
+        if (key == "name" || key == "firstname" || key == "firstnames" || key == "givenname") {
+            mapping.name = i;
+        } else if (key == "surname" || key == "lastname" || key == "familyname") {
+            mapping.surname = i;
+        } else if (key == "grade" || key == "class" || key == "gradelevel") {
+            mapping.grade = i;
+        } else if (key == "dateofbirth" || key == "dob" || key == "birthdate" || key == "birthday") {
+            mapping.dateOfBirth = i;
+        } else if (key == "contactno" || key == "contact" || key == "contactnumber" || key == "phone"
+                   || key == "cellphone" || key == "parentcontact") {
+            mapping.contactNo = i;
+        }
+    }
+    return mapping;
+}
+
+LearnerRosterImporter::LearnerRosterImporter(const Options& options)
+    : m_options(options)
+    , m_chunkInserted(0)
+    , m_chunkUpdated(0)
+    , m_chunkUnchanged(0)
+{
+}
+
+LearnerRosterImporter::Report LearnerRosterImporter::run(const QString& filePath, const CancelCheck& isCancelled,
+                                                         const ProgressCallback& onProgress) {
+    QElapsedTimer timer;
+    timer.start();
+
+    m_report = Report();
+    m_seenKeys.clear();
+    m_rows.clear();
+    m_chunkChanges.clear();
+    m_chunkInserted = m_chunkUpdated = m_chunkUnchanged = 0;
+
+    CsvReader reader(filePath, m_options.delimiter);
+    if (!reader.open()) {
+        m_report.error = "Cannot open " + filePath + ": " + reader.errorString();
+        return m_report;
+    }
+
+    QSqlDatabase db = DatabaseManager::instance().getDatabase();
+    m_lookup = QSqlQuery(db);
+    m_update = QSqlQuery(db);
+    m_lookup.setForwardOnly(true);
+
+    // json_each drives the join, so each roster row is one seek into the natural-key index
+    if (!m_lookup.prepare(R"(
+            SELECT k.key, l.id, l.grade, l.contact_no
+            FROM json_each(:keys) k
+            JOIN learners l
+              ON l.surname = json_extract(k.value, '$[1]') COLLATE NOCASE
+             AND l.name = json_extract(k.value, '$[0]') COLLATE NOCASE
+             AND l.date_of_birth = json_extract(k.value, '$[2]')
+        )")
+        || !m_update.prepare("UPDATE learners SET grade = :grade, contact_no = :contact_no WHERE id = :id")) {
+        m_report.error = "Failed to prepare the roster statements";
+        return m_report;
+    }
+
+    QStringList fields;
+    ColumnMapping mapping = m_options.mapping;
+    if (m_options.hasHeader) {
+        if (!reader.readRecord(fields)) {
+            m_report.error = "The file is empty";
+            return m_report;
+        }
+        if (!mapping.isValid()) {
+            mapping = ColumnMapping::fromHeader(fields);
+        }
+    }
+    if (!mapping.isValid()) {
+        m_report.error = "The file needs name, surname, grade and date of birth columns";
+        return m_report;
+    }
+
+    const int rowsPerLookup = qMax(1, m_options.rowsPerLookup);
+    const int rowsPerTransaction = qMax(rowsPerLookup, m_options.rowsPerTransaction);
+
+    auto field = [&fields](int column) {
+        return column >= 0 && column < fields.size() ? fields.at(column).trimmed() : QString();
+    };
+    auto reportProgress = [&]() {
+        if (onProgress) {
+            Progress progress;
+            progress.bytesRead = reader.bytesRead();
+            progress.totalBytes = reader.totalBytes();
+            progress.rowsRead = m_report.rowsRead;
+            qint64 elapsed = timer.elapsed();
+            progress.rowsPerSecond = elapsed > 0 ? m_report.rowsRead * 1000.0 / elapsed : 0.0;
+            onProgress(progress);
+        }
+    };
+    auto commitChunk = [&]() {
+        LibraryStatistics::instance().learnersChanged(int(m_chunkInserted));
+        m_report.inserted += m_chunkInserted;
+        m_report.updated += m_chunkUpdated;
+        m_report.unchanged += m_chunkUnchanged;
+        int room = kMaxChanges - m_report.changes.size();
+        m_report.changes += m_chunkChanges.mid(0, qMax(0, room));
+        m_chunkChanges.clear();
+        m_chunkInserted = m_chunkUpdated = m_chunkUnchanged = 0;
+    };
+    // The statistics must not recount between the commit and its report
+    auto commit = [&]() {
+        LibraryStatistics::PendingChange pendingChange;
+        if (!db.commit()) {
+            return false;
+        }
+        commitChunk();
+        return true;
+    };
+
+    if (!db.transaction()) {
+        m_report.error = "Failed to start database transaction: " + db.lastError().text();
+        return m_report;
+    }
+
+    QString error;
+    int rowsInChunk = 0;
+    while (reader.readRecord(fields)) {
+        ++m_report.rowsRead;
+
+        RosterRow row;
+        row.line = reader.lineNumber();
+        row.name = field(mapping.name);
+        row.surname = field(mapping.surname);
+        row.grade = field(mapping.grade);
+        row.contactNo = field(mapping.contactNo);
+        QDate dateOfBirth = parseDate(field(mapping.dateOfBirth));
+
+        if (row.name.isEmpty() || row.surname.isEmpty() || row.grade.isEmpty()) {
+            ++m_report.invalid;
+            addProblem(row.line, "Missing name, surname or grade");
+        } else if (!dateOfBirth.isValid()) {
+            ++m_report.invalid;
+            addProblem(row.line, "Invalid date of birth \"" + field(mapping.dateOfBirth) + "\"");
+        } else {
+            row.dateOfBirth = dateOfBirth.toString("yyyy-MM-dd");
+            QString key = naturalKey(row.name, row.surname, row.dateOfBirth);
+            if (m_seenKeys.contains(key)) {
+                ++m_report.duplicates;
+                addProblem(row.line, row.name + " " + row.surname + " appears more than once in the file");
+            } else {
+                m_seenKeys.insert(key);
+                m_rows.append(row);
+                ++rowsInChunk;
+
+                if (m_rows.size() >= rowsPerLookup && !flushRows(error)) {
+                    break;
+                }
+            }
+        }
+
+        if (rowsInChunk >= rowsPerTransaction) {
+            if (!flushRows(error)) {
+                break;
+            }
+            if (!commit()) {
+                error = "Failed to commit: " + db.lastError().text();
+                break;
+            }
+            rowsInChunk = 0;
+            if (!db.transaction()) {
+                m_report.error = "Failed to start database transaction: " + db.lastError().text();
+                m_report.elapsedMs = timer.elapsed();
+                return m_report;
+            }
+        }
+
+        if (m_report.rowsRead % 1000 == 0) {
+            if (isCancelled && isCancelled()) {
+                m_report.cancelled = true;
+                break;
+            }
+            reportProgress();
+        }
+    }
+
+    if (error.isEmpty() && !m_report.cancelled && flushRows(error)) {
+        if (!commit()) {
+            error = "Failed to commit: " + db.lastError().text();
+        }
+    }
+    if (!error.isEmpty() || m_report.cancelled) {
+        // Only the open chunk is lost; earlier chunks are already committed
+        m_lookup.finish();
+        m_update.finish();
+        db.rollback();
+    }
+    m_rows.clear();
+    m_chunkChanges.clear();
+    m_chunkInserted = m_chunkUpdated = m_chunkUnchanged = 0;
+
+    if (m_report.updated > 0) {
+        // Updated learners may be cached with their old grade
+        DatabaseManager::instance().clearEntityCaches();
+    }
+
+    // A profile without automatic checkpoints leaves the import in the WAL
+    if (DatabaseManager::instance().getStorageProfile().walAutoCheckpointPages <= 0) {
+        DatabaseManager::instance().checkpoint(StorageProfile::Checkpoint::Passive);
+    }
+
+    m_report.error = error;
+    m_report.elapsedMs = timer.elapsed();
+    reportProgress();
+    return m_report;
+}
+
+bool LearnerRosterImporter::flushRows(QString& error) {
+    if (m_rows.isEmpty()) {
+        return true;
+    }
+
+    QJsonArray keys;
+    for (const RosterRow& row : m_rows) {
+        keys.append(QJsonArray { row.name, row.surname, row.dateOfBirth });
+    }
+    m_lookup.bindValue(":keys", QString::fromUtf8(QJsonDocument(keys).toJson(QJsonDocument::Compact)));
+    if (!m_lookup.exec()) {
+        error = "Failed to look up learners: " + m_lookup.lastError().text();
+        return false;
+    }
+
+    struct Match {
+        int count = 0;
+        int id = 0;
+        QString grade;
+        QString contactNo;
+    };
+    QVector<Match> matches(m_rows.size());
+    while (m_lookup.next()) {
+        Match& match = matches[m_lookup.value(0).toInt()];
+        ++match.count;
+        match.id = m_lookup.value(1).toInt();
+        match.grade = m_lookup.value(2).toString();
+        match.contactNo = m_lookup.value(3).toString();
+    }
+    m_lookup.finish();
+
+    QVector<const RosterRow*> newRows;
+    for (int i = 0; i < m_rows.size(); ++i) {
+        const RosterRow& row = m_rows.at(i);
+        const Match& match = matches.at(i);
+
+        if (match.count == 0) {
+            newRows.append(&row);
+            continue;
+        }
+        if (match.count > 1) {
+            ++m_report.ambiguous;
+            addProblem(row.line, QString("%1 %2 matches %3 existing learners; not changed")
+                                     .arg(row.name, row.surname).arg(match.count));
+            continue;
+        }
+
+        // A blank contact number in the roster keeps the one on file
+        QString contactNo = row.contactNo.isEmpty() ? match.contactNo : row.contactNo;
+        if (row.grade == match.grade && contactNo == match.contactNo) {
+            ++m_chunkUnchanged;
+            continue;
+        }
+
+        m_update.bindValue(":grade", row.grade);
+        m_update.bindValue(":contact_no", contactNo);
+        m_update.bindValue(":id", match.id);
+        if (!m_update.exec()) {
+            error = "Failed to update learner: " + m_update.lastError().text();
+            return false;
+        }
+        ++m_chunkUpdated;
+
+        Change change;
+        change.kind = Change::Updated;
+        change.learnerId = match.id;
+        change.line = row.line;
+        change.name = row.name;
+        change.surname = row.surname;
+        change.oldGrade = match.grade;
+        change.newGrade = row.grade;
+        change.oldContactNo = match.contactNo;
+        change.newContactNo = contactNo;
+        m_chunkChanges.append(change);
+    }
+
+    if (!insertRows(newRows, error)) {
+        return false;
+    }
+    m_rows.clear();
+    return true;
+}
+
+bool LearnerRosterImporter::insertRows(const QVector<const RosterRow*>& rows, QString& error) {
+    const int rowsPerInsert = qBound(1, m_options.rowsPerInsert, kMaxBoundValues / kColumnsPerRow);
+    QSqlQuery insert(DatabaseManager::instance().getDatabase());
+
+    for (int start = 0; start < rows.size(); start += rowsPerInsert) {
+        const int count = qMin(rowsPerInsert, int(rows.size()) - start);
+        QStringList values;
+        for (int i = 0; i < count; ++i) {
+            values << "(?, ?, ?, ?, ?)";
+        }
+        if (!insert.prepare("INSERT INTO learners (name, surname, grade, date_of_birth, contact_no) VALUES "
+                            + values.join(", "))) {
+            error = "Failed to prepare the learner insert statement";
+            return false;
+        }
+
+        int index = 0;
+        for (int i = start; i < start + count; ++i) {
+            const RosterRow* row = rows.at(i);
+            insert.bindValue(index++, row->name);
+            insert.bindValue(index++, row->surname);
+            insert.bindValue(index++, row->grade);
+            insert.bindValue(index++, row->dateOfBirth);
+            insert.bindValue(index++, row->contactNo);
+
+            Change change;
+            change.kind = Change::Inserted;
+            change.line = row->line;
+            change.name = row->name;
+            change.surname = row->surname;
+            change.newGrade = row->grade;
+            change.newContactNo = row->contactNo;
+            m_chunkChanges.append(change);
+        }
+        if (!insert.exec()) {
+            error = "Failed to insert learners: " + insert.lastError().text();
+            return false;
+        }
+        m_chunkInserted += count;
+    }
+    return true;
+}
+
+void LearnerRosterImporter::addProblem(int line, const QString& message) {
+    if (m_report.problems.size() < kMaxProblems) {
+        m_report.problems << QString("Line %1: %2").arg(line).arg(message);
+    }
+}
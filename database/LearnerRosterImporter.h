@@ -0,0 +1,119 @@
+#ifndef LEARNERROSTERIMPORTER_H
+#define LEARNERROSTERIMPORTER_H
+
+#include <QSet>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+// Streams a class roster CSV into the learners table on the calling thread's
+// connection. Learners are matched on (surname, name, date of birth), case
+// insensitively, through idx_learners_natural_key: matches get their grade and
+// contact number updated when they differ, the rest are inserted. Work is done
+// in chunked transactions; cancelling keeps the chunks already committed.
+class LearnerRosterImporter {
+public:
+    // Zero-based CSV column of each learner field, -1 if the file lacks it
+    struct ColumnMapping {
+        int name = -1;
+        int surname = -1;
+        int grade = -1;
+        int dateOfBirth = -1;
+        int contactNo = -1;
+
+        // Recognises headers such as "First Name", "Surname", "Class", "DOB"
+        static ColumnMapping fromHeader(const QStringList& header);
+        bool isValid() const { return name >= 0 && surname >= 0 && grade >= 0 && dateOfBirth >= 0; }
+    };
+
+    struct Options {
+        ColumnMapping mapping;    // Left invalid, it is taken from the header row
+        bool hasHeader = true;
+        QChar delimiter = ',';
+        int rowsPerLookup = 500;
+        int rowsPerInsert = 100;
+        int rowsPerTransaction = 5000;
+    };
+
+    struct Progress {
+        qint64 bytesRead = 0;
+        qint64 totalBytes = 0;
+        qint64 rowsRead = 0;
+        double rowsPerSecond = 0.0;
+    };
+
+    // One inserted or updated learner; unchanged rows are only counted
+    struct Change {
+        enum Kind { Inserted, Updated };
+
+        Kind kind = Inserted;
+        int learnerId = 0;    // Updated rows only
+        int line = 0;
+        QString name;
+        QString surname;
+        QString oldGrade;
+        QString newGrade;
+        QString oldContactNo;
+        QString newContactNo;
+    };
+
+    struct Report {
+        qint64 rowsRead = 0;
+        qint64 inserted = 0;
+        qint64 updated = 0;
+        qint64 unchanged = 0;
+        qint64 duplicates = 0;    // Same learner twice in the file
+        qint64 ambiguous = 0;     // Matches more than one existing learner
+        qint64 invalid = 0;
+        qint64 elapsedMs = 0;
+        bool cancelled = false;
+        QString error;
+        QStringList problems;     // First few rejected rows, with line numbers
+        QVector<Change> changes;  // Committed inserts and updates, capped
+
+        double rowsPerSecond() const {
+            return elapsedMs > 0 ? rowsRead * 1000.0 / elapsedMs : 0.0;
+        }
+    };
+
+    using CancelCheck = std::function<bool()>;
+    using ProgressCallback = std::function<void(const Progress&)>;
+
+    explicit LearnerRosterImporter(const Options& options = Options());
+
+    Report run(const QString& filePath, const CancelCheck& isCancelled = CancelCheck(),
+               const ProgressCallback& onProgress = ProgressCallback());
+
+private:
+    static constexpr int kColumnsPerRow = 5;
+    static constexpr int kMaxProblems = 100;
+    static constexpr int kMaxChanges = 5000;
+
+    struct RosterRow {
+        int line;
+        QString name;
+        QString surname;
+        QString grade;
+        QString dateOfBirth;    // yyyy-MM-dd, as stored
+        QString contactNo;
+    };
+
+    bool flushRows(QString& error);
+    bool insertRows(const QVector<const RosterRow*>& rows, QString& error);
+    void addProblem(int line, const QString& message);
+
+    Options m_options;
+    Report m_report;
+    QSet<QString> m_seenKeys;
+    QVector<RosterRow> m_rows;          // Rows waiting for the next lookup
+    QVector<Change> m_chunkChanges;     // Moved into the report on commit
+    qint64 m_chunkInserted;
+    qint64 m_chunkUpdated;
+    qint64 m_chunkUnchanged;
+    QSqlQuery m_lookup;
+    QSqlQuery m_update;
+};
+
+#endif // LEARNERROSTERIMPORTER_H
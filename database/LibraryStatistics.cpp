@@ -0,0 +1,329 @@
+#include "LibraryStatistics.h"
+#include "AsyncDatabase.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+
+namespace {
+
+int statusIndex(Book::Status status) {
+    return static_cast<int>(status);
+}
+
+}
+
+LibraryStatistics& LibraryStatistics::instance() {
+    static LibraryStatistics instance;
+    return instance;
+}
+
+LibraryStatistics::LibraryStatistics()
+    : m_seeded(false)
+    , m_version(0)
+    , m_pendingChanges(0)
+    , m_overdue(0)
+    , m_reconcileTimer(this)
+    , m_reconciling(false)
+{
+    // The first caller may be a worker; the timer needs the GUI event loop
+    if (QCoreApplication::instance()) {
+        moveToThread(QCoreApplication::instance()->thread());
+    }
+    connect(&m_reconcileTimer, &QTimer::timeout, this, &LibraryStatistics::startReconcile);
+}
+
+// ==================== Seeding ====================
+
+// One read transaction, so all counters come from the same snapshot. The
+// active-loan query is answered from idx_transactions_status_due alone.
+bool LibraryStatistics::recount(Counts& counts, QString& error) {
+    QSqlDatabase db = DatabaseManager::instance().getDatabase();
+    if (!db.transaction()) {
+        error = "Failed to start read transaction: " + db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    bool ok = query.exec("SELECT status, COUNT(*) FROM books GROUP BY status");
+    while (ok && query.next()) {
+        Book::Status status = Book::stringToStatus(query.value(0).toString());
+        counts.books[statusIndex(status)] += query.value(1).toInt();
+    }
+
+    ok = ok && query.exec("SELECT (SELECT COUNT(*) FROM learners), (SELECT COUNT(*) FROM users)") && query.next();
+    if (ok) {
+        counts.learners = query.value(0).toInt();
+        counts.users = query.value(1).toInt();
+    }
+
+    ok = ok && query.exec(R"(
+        SELECT learner_id, due_date, COUNT(*) FROM transactions
+        WHERE status = 'Active'
+        GROUP BY due_date, learner_id
+    )");
+    while (ok && query.next()) {
+        int learnerId = query.value(0).toInt();
+        int loans = query.value(2).toInt();
+        counts.activeLoansByLearner[learnerId] += loans;
+        counts.activeLoansByDue[query.value(1).toDate()] += loans;
+    }
+
+    if (!ok) {
+        error = "Failed to count library statistics: " + query.lastError().text();
+    }
+    query.finish();
+    db.commit();
+    return ok;
+}
+
+bool LibraryStatistics::seed() {
+    for (int attempt = 0; attempt < kSeedAttempts; ++attempt) {
+        quint64 version;
+        {
+            QMutexLocker locker(&m_mutex);
+            version = m_version;
+        }
+
+        Counts counts;
+        QString error;
+        if (!recount(counts, error)) {
+            qWarning() << error;
+            return false;
+        }
+
+        QMutexLocker locker(&m_mutex);
+        // A change committed while counting, or committed but not yet
+        // reported, may or may not be in the counts
+        if (m_version == version && m_pendingChanges == 0) {
+            install(counts);
+            return true;
+        }
+    }
+    qWarning() << "Library statistics kept changing while being counted; will retry on next read";
+    return false;
+}
+
+void LibraryStatistics::install(const Counts& counts) {
+    m_counts = counts;
+    m_today = QDate::currentDate();
+    m_overdue = overdueAsOf(m_counts, m_today);
+    m_seeded = true;
+}
+
+bool LibraryStatistics::isSeeded() const {
+    QMutexLocker locker(&m_mutex);
+    return m_seeded;
+}
+
+void LibraryStatistics::invalidate() {
+    QMutexLocker locker(&m_mutex);
+    ++m_version;
+    m_seeded = false;
+}
+
+// ==================== Reading ====================
+
+int LibraryStatistics::overdueAsOf(const Counts& counts, const QDate& today) {
+    int overdue = 0;
+    for (auto it = counts.activeLoansByDue.cbegin(); it != counts.activeLoansByDue.cend() && it.key() < today;
+         ++it) {
+        overdue += it.value();
+    }
+    return overdue;
+}
+
+// Once a day the loans that fell due yesterday join the overdue count
+void LibraryStatistics::rollToToday() {
+    QDate today = QDate::currentDate();
+    if (today != m_today) {
+        m_today = today;
+        m_overdue = overdueAsOf(m_counts, today);
+    }
+}
+
+DatabaseManager::DashboardStats LibraryStatistics::statsFrom(const Counts& counts, int overdue) {
+    DatabaseManager::DashboardStats stats;
+    stats.availableBooks = counts.books[statusIndex(Book::Status::Available)];
+    stats.borrowedBooks = counts.books[statusIndex(Book::Status::Borrowed)];
+    stats.lostBooks = counts.books[statusIndex(Book::Status::Lost)];
+    stats.totalBooks = stats.availableBooks + stats.borrowedBooks + stats.lostBooks;
+    stats.totalLearners = counts.learners;
+    stats.activeLearners = counts.activeLoansByLearner.size();
+    stats.totalUsers = counts.users;
+    stats.overdueBooks = overdue;
+    return stats;
+}
+
+DatabaseManager::DashboardStats LibraryStatistics::snapshot() {
+    QMutexLocker locker(&m_mutex);
+    rollToToday();
+    return statsFrom(m_counts, m_overdue);
+}
+
+// ==================== Change Reports ====================
+
+LibraryStatistics::PendingChange::PendingChange() {
+    LibraryStatistics& statistics = LibraryStatistics::instance();
+    QMutexLocker locker(&statistics.m_mutex);
+    ++statistics.m_pendingChanges;
+    ++statistics.m_version;
+}
+
+LibraryStatistics::PendingChange::~PendingChange() {
+    LibraryStatistics& statistics = LibraryStatistics::instance();
+    QMutexLocker locker(&statistics.m_mutex);
+    --statistics.m_pendingChanges;
+    ++statistics.m_version;
+}
+
+void LibraryStatistics::booksAdded(Book::Status status, int count) {
+    QMutexLocker locker(&m_mutex);
+    ++m_version;
+    if (m_seeded) {
+        m_counts.books[statusIndex(status)] += count;
+    }
+}
+
+void LibraryStatistics::bookRemoved(Book::Status status) {
+    booksAdded(status, -1);
+}
+
+void LibraryStatistics::bookStatusChanged(Book::Status from, Book::Status to) {
+    QMutexLocker locker(&m_mutex);
+    ++m_version;
+    if (m_seeded && from != to) {
+        --m_counts.books[statusIndex(from)];
+        ++m_counts.books[statusIndex(to)];
+    }
+}
+
+void LibraryStatistics::loanOpened(int learnerId, const QDate& dueDate) {
+    QMutexLocker locker(&m_mutex);
+    ++m_version;
+    if (!m_seeded) {
+        return;
+    }
+    rollToToday();
+    ++m_counts.activeLoansByLearner[learnerId];
+    ++m_counts.activeLoansByDue[dueDate];
+    if (dueDate < m_today) {
+        ++m_overdue;
+    }
+}
+
+void LibraryStatistics::loanClosed(int learnerId, const QDate& dueDate) {
+    QMutexLocker locker(&m_mutex);
+    ++m_version;
+    if (!m_seeded) {
+        return;
+    }
+    rollToToday();
+
+    auto learner = m_counts.activeLoansByLearner.find(learnerId);
+    if (learner != m_counts.activeLoansByLearner.end() && --learner.value() <= 0) {
+        m_counts.activeLoansByLearner.erase(learner);
+    }
+    auto due = m_counts.activeLoansByDue.find(dueDate);
+    if (due != m_counts.activeLoansByDue.end() && --due.value() <= 0) {
+        m_counts.activeLoansByDue.erase(due);
+    }
+    if (dueDate < m_today) {
+        --m_overdue;
+    }
+}
+
+void LibraryStatistics::learnersChanged(int delta) {
+    QMutexLocker locker(&m_mutex);
+    ++m_version;
+    if (m_seeded) {
+        m_counts.learners += delta;
+    }
+}
+
+void LibraryStatistics::usersChanged(int delta) {
+    QMutexLocker locker(&m_mutex);
+    ++m_version;
+    if (m_seeded) {
+        m_counts.users += delta;
+    }
+}
+
+// ==================== Reconciliation ====================
+
+void LibraryStatistics::setReconcileInterval(int minutes) {
+    if (minutes <= 0) {
+        m_reconcileTimer.stop();
+        return;
+    }
+    m_reconcileTimer.start(minutes * 60 * 1000);
+}
+
+void LibraryStatistics::startReconcile() {
+    if (m_reconciling) {
+        return;
+    }
+    m_reconciling = true;
+
+    auto future = AsyncDatabase::instance().run<QStringList>([](DatabaseManager&) {
+        return LibraryStatistics::instance().reconcile();
+    });
+    future.then(this, [this](const QStringList& drift) {
+        m_reconciling = false;
+        if (!drift.isEmpty()) {
+            emit driftDetected(drift);
+        }
+    });
+}
+
+QStringList LibraryStatistics::reconcile() {
+    quint64 version;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_seeded) {
+            return QStringList();
+        }
+        version = m_version;
+    }
+
+    Counts counts;
+    QString error;
+    if (!recount(counts, error)) {
+        qWarning() << error;
+        return QStringList();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_seeded || m_version != version || m_pendingChanges > 0) {
+        // Counters moved while counting; comparing now could report false drift
+        qDebug() << "Library statistics changed during reconciliation; skipped";
+        return QStringList();
+    }
+
+    rollToToday();
+    const DatabaseManager::DashboardStats held = statsFrom(m_counts, m_overdue);
+    const DatabaseManager::DashboardStats actual = statsFrom(counts, overdueAsOf(counts, m_today));
+
+    QStringList drift;
+    auto compare = [&drift](const char* name, int heldValue, int actualValue) {
+        if (heldValue != actualValue) {
+            drift << QString("%1: counter %2, database %3").arg(name).arg(heldValue).arg(actualValue);
+        }
+    };
+    compare("totalBooks", held.totalBooks, actual.totalBooks);
+    compare("availableBooks", held.availableBooks, actual.availableBooks);
+    compare("borrowedBooks", held.borrowedBooks, actual.borrowedBooks);
+    compare("lostBooks", held.lostBooks, actual.lostBooks);
+    compare("totalLearners", held.totalLearners, actual.totalLearners);
+    compare("activeLearners", held.activeLearners, actual.activeLearners);
+    compare("totalUsers", held.totalUsers, actual.totalUsers);
+    compare("overdueBooks", held.overdueBooks, actual.overdueBooks);
+
+    if (!drift.isEmpty() || m_counts.activeLoansByDue != counts.activeLoansByDue) {
+        qWarning() << "Library statistics drifted from the database:" << drift;
+        install(counts);
+    }
+    return drift;
+}
@@ -0,0 +1,100 @@
+#ifndef LIBRARYSTATISTICS_H
+#define LIBRARYSTATISTICS_H
+
+#include <QObject>
+#include <QDate>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QStringList>
+#include <QTimer>
+#include <array>
+#include "DatabaseManager.h"
+
+// Dashboard counters held in memory. seed() counts everything once in SQL;
+// after that DatabaseManager reports each committed change and snapshot()
+// only copies numbers. The overdue count follows the calendar through a
+// histogram of active loans by due date.
+//
+// Changes made outside DatabaseManager (or lost to a race with seeding) show
+// up as drift in reconcile(), which recounts on a worker, corrects the
+// counters and reports what was off.
+class LibraryStatistics : public QObject {
+    Q_OBJECT
+
+public:
+    static LibraryStatistics& instance();
+
+    // Both run SQL on the calling thread's connection
+    bool seed();
+    QStringList reconcile();
+
+    bool isSeeded() const;
+    // The next getDashboardStats() seeds again
+    void invalidate();
+
+    DatabaseManager::DashboardStats snapshot();
+
+    // Held by a writer from before its COMMIT until it has reported the
+    // change below, so a recount never installs counts that already hold a
+    // change whose report is still to come
+    class PendingChange {
+    public:
+        PendingChange();
+        ~PendingChange();
+
+    private:
+        PendingChange(const PendingChange&) = delete;
+        PendingChange& operator=(const PendingChange&) = delete;
+    };
+
+    // Reported by DatabaseManager after commit, inside a PendingChange
+    void booksAdded(Book::Status status, int count = 1);
+    void bookRemoved(Book::Status status);
+    void bookStatusChanged(Book::Status from, Book::Status to);
+    void loanOpened(int learnerId, const QDate& dueDate);
+    void loanClosed(int learnerId, const QDate& dueDate);
+    void learnersChanged(int delta);
+    void usersChanged(int delta);
+
+    // Reconciles on a worker every intervalMinutes; 0 turns it off
+    void setReconcileInterval(int minutes);
+
+signals:
+    void driftDetected(const QStringList& drift);
+
+private:
+    struct Counts {
+        std::array<int, 3> books = { 0, 0, 0 };    // By Book::Status
+        int learners = 0;
+        int users = 0;
+        QHash<int, int> activeLoansByLearner;
+        QMap<QDate, int> activeLoansByDue;
+    };
+
+    static constexpr int kSeedAttempts = 3;
+
+    LibraryStatistics();
+    LibraryStatistics(const LibraryStatistics&) = delete;
+    LibraryStatistics& operator=(const LibraryStatistics&) = delete;
+
+    static bool recount(Counts& counts, QString& error);
+    static DatabaseManager::DashboardStats statsFrom(const Counts& counts, int overdue);
+    static int overdueAsOf(const Counts& counts, const QDate& today);
+    void install(const Counts& counts);
+    void rollToToday();
+    void startReconcile();
+
+    mutable QMutex m_mutex;
+    bool m_seeded;
+    quint64 m_version;      // Bumped by every change report, seeded or not
+    int m_pendingChanges;   // Open PendingChange guards
+    Counts m_counts;
+    QDate m_today;          // m_overdue counts loans due before this date
+    int m_overdue;
+
+    QTimer m_reconcileTimer;
+    bool m_reconciling;
+};
+
+#endif // LIBRARYSTATISTICS_H
@@ -0,0 +1,133 @@
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtGlobal>
+#include <list>
+#include <utility>
+
+struct LruCacheStats {
+    qint64 hits = 0;
+    qint64 misses = 0;
+    qint64 evictions = 0;
+    int size = 0;
+    int capacity = 0;
+
+    double hitRate() const {
+        qint64 lookups = hits + misses;
+        return lookups > 0 ? double(hits) / double(lookups) : 0.0;
+    }
+};
+
+// Size-bounded, least-recently-used map of values keyed by id. Safe to share
+// between threads.
+//
+// Writers call remove() after their change is visible to other connections.
+// Readers take generation() before querying and pass it to insert(); if any
+// entry was removed in between, the row they read may be stale and is not
+// cached.
+template <typename Key, typename T>
+class LruCache {
+public:
+    using Stats = LruCacheStats;
+
+    explicit LruCache(int capacity) : m_capacity(qMax(0, capacity)) {}
+
+    bool lookup(const Key& key, T* value) {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_index.constFind(key);
+        if (it == m_index.constEnd()) {
+            ++m_stats.misses;
+            return false;
+        }
+        ++m_stats.hits;
+        m_entries.splice(m_entries.begin(), m_entries, it.value());
+        *value = it.value()->second;
+        return true;
+    }
+
+    quint64 generation() const {
+        QMutexLocker locker(&m_mutex);
+        return m_generation;
+    }
+
+    void insert(const Key& key, const T& value, quint64 generation) {
+        QMutexLocker locker(&m_mutex);
+        if (generation != m_generation || m_capacity == 0) {
+            return;
+        }
+
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            it.value()->second = value;
+            m_entries.splice(m_entries.begin(), m_entries, it.value());
+            return;
+        }
+
+        m_entries.emplace_front(key, value);
+        m_index.insert(key, m_entries.begin());
+        trim();
+    }
+
+    void remove(const Key& key) {
+        QMutexLocker locker(&m_mutex);
+        ++m_generation;
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_entries.erase(it.value());
+            m_index.erase(it);
+        }
+    }
+
+    void clear() {
+        QMutexLocker locker(&m_mutex);
+        ++m_generation;
+        m_entries.clear();
+        m_index.clear();
+    }
+
+    void setCapacity(int capacity) {
+        QMutexLocker locker(&m_mutex);
+        m_capacity = qMax(0, capacity);
+        trim();
+    }
+
+    Stats stats() const {
+        QMutexLocker locker(&m_mutex);
+        Stats stats = m_stats;
+        stats.size = m_index.size();
+        stats.capacity = m_capacity;
+        return stats;
+    }
+
+    void resetStats() {
+        QMutexLocker locker(&m_mutex);
+        m_stats = Stats();
+    }
+
+private:
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    // Caller holds m_mutex
+    void trim() {
+        while (int(m_index.size()) > m_capacity) {
+            m_index.remove(m_entries.back().first);
+            m_entries.pop_back();
+            ++m_stats.evictions;
+        }
+    }
+
+    using Entry = std::pair<Key, T>;
+
+    mutable QMutex m_mutex;
+    std::list<Entry> m_entries;    // Most recently used first
+    QHash<Key, typename std::list<Entry>::iterator> m_index;
+    int m_capacity;
+    quint64 m_generation = 0;
+    Stats m_stats;
+};
+
+#endif // LRUCACHE_H
@@ -0,0 +1,28 @@
+#ifndef PAGINATION_H
+#define PAGINATION_H
+
+#include <QVariantList>
+#include <QVector>
+
+// Position after the last row of a page: the sort-key values of that row
+// plus its id as a tie-breaker. A default cursor means "first page".
+// A cursor is only meaningful for the sort order that produced it.
+// Orders with no key to seek by (search relevance) continue from offset.
+struct PageCursor {
+    QVariantList keys;
+    int lastId;
+    int offset;
+
+    PageCursor() : lastId(-1), offset(0) {}
+    bool isStart() const { return lastId < 0; }
+};
+
+template <typename T>
+struct Page {
+    QVector<T> items;
+    PageCursor next;    // Pass back in to fetch the following page
+    bool hasMore = false;
+    int estimatedTotal = -1;    // Rows in all pages, from a cheap count; first page only, -1 if unknown
+};
+
+#endif // PAGINATION_H
@@ -0,0 +1,51 @@
+#include "ReturnScanQueue.h"
+#include "AsyncDatabase.h"
+
+ReturnScanQueue::ReturnScanQueue(QObject* parent)
+    : QObject(parent)
+    , m_inFlight(0)
+{
+}
+
+void ReturnScanQueue::enqueue(const QString& bookCode, const QDate& returnDate) {
+    QString code = bookCode.trimmed();
+    if (code.isEmpty()) {
+        return;
+    }
+
+    m_pending.enqueue({code, returnDate});
+    emit pendingCountChanged(pendingCount());
+    flush();
+}
+
+int ReturnScanQueue::pendingCount() const {
+    return m_pending.size() + m_inFlight;
+}
+
+void ReturnScanQueue::flush() {
+    if (m_inFlight > 0 || m_pending.isEmpty()) {
+        return;
+    }
+
+    // A batch shares one return date, so it stops where the date changes
+    QStringList codes;
+    QDate returnDate = m_pending.head().returnDate;
+    while (!m_pending.isEmpty() && codes.size() < kMaxBatchSize && m_pending.head().returnDate == returnDate) {
+        codes << m_pending.dequeue().bookCode;
+    }
+    m_inFlight = codes.size();
+
+    m_batch = AsyncDatabase::instance().run<QVector<DatabaseManager::ScanReturnResult>>(
+        [codes, returnDate](DatabaseManager& db) {
+            return db.returnBooksByCodes(codes, returnDate);
+        });
+
+    m_batch.then(this, [this](const QVector<DatabaseManager::ScanReturnResult>& results) {
+        m_inFlight = 0;
+        for (const DatabaseManager::ScanReturnResult& result : results) {
+            emit scanProcessed(result);
+        }
+        emit pendingCountChanged(pendingCount());
+        flush();
+    });
+}
@@ -0,0 +1,42 @@
+#ifndef RETURNSCANQUEUE_H
+#define RETURNSCANQUEUE_H
+
+#include <QObject>
+#include <QDate>
+#include <QFuture>
+#include <QQueue>
+#include "DatabaseManager.h"
+
+// Continuous return mode: scanned book codes are queued on the GUI thread and
+// returned in the background. One batch is in flight at a time; scans that
+// arrive meanwhile are committed together in the next one, so a fast scanner
+// produces larger group commits instead of a backlog of transactions.
+class ReturnScanQueue : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int kMaxBatchSize = 50;
+
+    explicit ReturnScanQueue(QObject* parent = nullptr);
+
+    void enqueue(const QString& bookCode, const QDate& returnDate);
+    int pendingCount() const;
+
+signals:
+    void scanProcessed(const DatabaseManager::ScanReturnResult& result);
+    void pendingCountChanged(int pending);
+
+private:
+    struct Scan {
+        QString bookCode;
+        QDate returnDate;
+    };
+
+    void flush();
+
+    QQueue<Scan> m_pending;
+    int m_inFlight;
+    QFuture<QVector<DatabaseManager::ScanReturnResult>> m_batch;
+};
+
+#endif // RETURNSCANQUEUE_H
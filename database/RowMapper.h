@@ -0,0 +1,272 @@
+#ifndef ROWMAPPER_H
+#define ROWMAPPER_H
+
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVector>
+#include <array>
+#include "User.h"
+#include "Learner.h"
+#include "Book.h"
+#include "Transaction.h"
+#include "Payments.h"
+#include "PaymentItem.h"
+
+// Maps result rows onto model objects by column position.
+//
+// Each RowMapper<T> lists its columns once, in the same order as its Column
+// enum (checked at compile time). Queries select exactly those columns via
+// selectColumns<T>(), so map() reads query.value(ordinal) and never looks a
+// column up by name.
+template <typename T>
+struct RowMapper;
+
+// "id, title, ..." or "b.id, b.title, ..." for joins
+template <typename T>
+QString selectColumns(const char* alias = nullptr) {
+    QStringList list;
+    for (const char* column : RowMapper<T>::columns) {
+        list << (alias ? QString("%1.%2").arg(alias, column) : QString(column));
+    }
+    return list.join(", ");
+}
+
+// Ordinal of a column in RowMapper<T>::columns, or -1
+template <typename T>
+int columnIndex(const QString& column) {
+    for (int i = 0; i < int(RowMapper<T>::columns.size()); ++i) {
+        if (column == QLatin1String(RowMapper<T>::columns[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+template <typename T>
+QVector<T> mapRows(QSqlQuery& query) {
+    QVector<T> rows;
+    while (query.next()) {
+        rows.append(RowMapper<T>::map(query));
+    }
+    return rows;
+}
+
+// ==================== Full Models ====================
+
+template <>
+struct RowMapper<Book> {
+    enum Column { Id, BookCode, Isbn, Title, Author, Subject, Grade, Price, Status, CreatedAt, ColumnCount };
+    static constexpr std::array columns {
+        "id", "book_code", "isbn", "title", "author", "subject", "grade", "price", "status", "created_at"
+    };
+    static_assert(columns.size() == ColumnCount, "column list must match the Column enum");
+
+    static Book map(const QSqlQuery& query) {
+        return Book(
+            query.value(Id).toInt(),
+            query.value(BookCode).toString(),
+            query.value(Isbn).toString(),
+            query.value(Title).toString(),
+            query.value(Author).toString(),
+            query.value(Subject).toString(),
+            query.value(Grade).toString(),
+            query.value(Price).toDouble(),
+            Book::stringToStatus(query.value(Status).toString()),
+            query.value(CreatedAt).toDateTime()
+        );
+    }
+};
+
+template <>
+struct RowMapper<Learner> {
+    enum Column { Id, Name, Surname, Grade, DateOfBirth, ContactNo, CreatedAt, ColumnCount };
+    static constexpr std::array columns {
+        "id", "name", "surname", "grade", "date_of_birth", "contact_no", "created_at"
+    };
+    static_assert(columns.size() == ColumnCount, "column list must match the Column enum");
+
+    static Learner map(const QSqlQuery& query) {
+        return Learner(
+            query.value(Id).toInt(),
+            query.value(Name).toString(),
+            query.value(Surname).toString(),
+            query.value(Grade).toString(),
+            query.value(DateOfBirth).toDate(),
+            query.value(ContactNo).toString(),
+            query.value(CreatedAt).toDateTime()
+        );
+    }
+};
+
+template <>
+struct RowMapper<Transaction> {
+    enum Column { Id, LearnerId, BookId, BorrowDate, DueDate, ReturnDate, Status, CreatedAt, ColumnCount };
+    static constexpr std::array columns {
+        "id", "learner_id", "book_id", "borrow_date", "due_date", "return_date", "status", "created_at"
+    };
+    static_assert(columns.size() == ColumnCount, "column list must match the Column enum");
+
+    static Transaction map(const QSqlQuery& query) {
+        return Transaction(
+            query.value(Id).toInt(),
+            query.value(LearnerId).toInt(),
+            query.value(BookId).toInt(),
+            query.value(BorrowDate).toDate(),
+            query.value(DueDate).toDate(),
+            query.value(ReturnDate).toDate(),
+            Transaction::stringToStatus(query.value(Status).toString()),
+            query.value(CreatedAt).toDateTime()
+        );
+    }
+};
+
+template <>
+struct RowMapper<User> {
+    enum Column {
+        Id, Username, PasswordHash, Name, Surname, Email, ContactNo, SchoolName,
+        Role, SecurityQuestion, SecurityAnswer, CreatedAt, ColumnCount
+    };
+    static constexpr std::array columns {
+        "id", "username", "password_hash", "name", "surname", "email", "contact_no",
+        "school_name", "role", "security_question", "security_answer", "created_at"
+    };
+    static_assert(columns.size() == ColumnCount, "column list must match the Column enum");
+
+    static User map(const QSqlQuery& query) {
+        return User(
+            query.value(Id).toInt(),
+            query.value(Username).toString(),
+            query.value(PasswordHash).toString(),
+            query.value(Name).toString(),
+            query.value(Surname).toString(),
+            query.value(Email).toString(),
+            query.value(ContactNo).toString(),
+            query.value(SchoolName).toString(),
+            User::stringToRole(query.value(Role).toString()),
+            query.value(SecurityQuestion).toString(),
+            query.value(SecurityAnswer).toString(),
+            query.value(CreatedAt).toDateTime()
+        );
+    }
+};
+
+template <>
+struct RowMapper<Payments> {
+    enum Column { Id, ReceiptNo, LearnerId, Amount, ProcessedBy, PaymentDate, Notes, ColumnCount };
+    static constexpr std::array columns {
+        "id", "receipt_no", "learner_id", "amount", "processed_by", "payment_date", "notes"
+    };
+    static_assert(columns.size() == ColumnCount, "column list must match the Column enum");
+
+    static Payments map(const QSqlQuery& query) {
+        return Payments(
+            query.value(Id).toInt(),
+            query.value(ReceiptNo).toString(),
+            query.value(LearnerId).toInt(),
+            query.value(Amount).toDouble(),
+            query.value(ProcessedBy).toInt(),
+            query.value(PaymentDate).toDateTime(),
+            query.value(Notes).toString()
+        );
+    }
+};
+
+template <>
+struct RowMapper<PaymentItem> {
+    enum Column { Id, PaymentId, TransactionId, BookId, Amount, ColumnCount };
+    static constexpr std::array columns {
+        "id", "payment_id", "transaction_id", "book_id", "amount"
+    };
+    static_assert(columns.size() == ColumnCount, "column list must match the Column enum");
+
+    static PaymentItem map(const QSqlQuery& query) {
+        return PaymentItem(
+            query.value(Id).toInt(),
+            query.value(PaymentId).toInt(),
+            query.value(TransactionId).toInt(),
+            query.value(BookId).toInt(),
+            query.value(Amount).toDouble()
+        );
+    }
+};
+
+// ==================== List Projections ====================
+
+// Columns are qualified: select from kTransactionDetailFrom's aliases
+template <>
+struct RowMapper<TransactionDetail> {
+    enum Column {
+        Id, LearnerId, BookId, BorrowDate, DueDate, ReturnDate, Status, CreatedAt,
+        BookCode, BookTitle, BookPrice, LearnerName, LearnerSurname, ColumnCount
+    };
+    static constexpr std::array columns {
+        "t.id", "t.learner_id", "t.book_id", "t.borrow_date", "t.due_date", "t.return_date",
+        "t.status", "t.created_at", "b.book_code", "b.title", "b.price", "l.name", "l.surname"
+    };
+    static_assert(columns.size() == ColumnCount, "column list must match the Column enum");
+
+    static TransactionDetail map(const QSqlQuery& query) {
+        TransactionDetail detail;
+        detail.transaction = Transaction(
+            query.value(Id).toInt(),
+            query.value(LearnerId).toInt(),
+            query.value(BookId).toInt(),
+            query.value(BorrowDate).toDate(),
+            query.value(DueDate).toDate(),
+            query.value(ReturnDate).toDate(),
+            Transaction::stringToStatus(query.value(Status).toString()),
+            query.value(CreatedAt).toDateTime()
+        );
+        detail.bookCode = query.value(BookCode).toString();
+        detail.bookTitle = query.value(BookTitle).toString();
+        detail.bookPrice = query.value(BookPrice).toDouble();
+        detail.learnerName = query.value(LearnerName).toString();
+        detail.learnerSurname = query.value(LearnerSurname).toString();
+        return detail;
+    }
+};
+
+template <>
+struct RowMapper<BookListRow> {
+    enum Column { Id, BookCode, Title, Author, Subject, Grade, Price, Status, ColumnCount };
+    static constexpr std::array columns {
+        "id", "book_code", "title", "author", "subject", "grade", "price", "status"
+    };
+    static_assert(columns.size() == ColumnCount, "column list must match the Column enum");
+
+    static BookListRow map(const QSqlQuery& query) {
+        BookListRow row;
+        row.id = query.value(Id).toInt();
+        row.bookCode = query.value(BookCode).toString();
+        row.title = query.value(Title).toString();
+        row.author = query.value(Author).toString();
+        row.subject = query.value(Subject).toString();
+        row.grade = query.value(Grade).toString();
+        row.price = query.value(Price).toDouble();
+        row.status = Book::stringToStatus(query.value(Status).toString());
+        return row;
+    }
+};
+
+template <>
+struct RowMapper<UserListRow> {
+    enum Column { Id, Username, Name, Surname, Email, ContactNo, Role, ColumnCount };
+    static constexpr std::array columns {
+        "id", "username", "name", "surname", "email", "contact_no", "role"
+    };
+    static_assert(columns.size() == ColumnCount, "column list must match the Column enum");
+
+    static UserListRow map(const QSqlQuery& query) {
+        UserListRow row;
+        row.id = query.value(Id).toInt();
+        row.username = query.value(Username).toString();
+        row.name = query.value(Name).toString();
+        row.surname = query.value(Surname).toString();
+        row.email = query.value(Email).toString();
+        row.contactNo = query.value(ContactNo).toString();
+        row.role = User::stringToRole(query.value(Role).toString());
+        return row;
+    }
+};
+
+#endif // ROWMAPPER_H
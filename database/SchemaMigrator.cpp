@@ -0,0 +1,350 @@
+#include "SchemaMigrator.h"
+#include <QSqlError>
+#include <QStringList>
+#include <QDebug>
+
+namespace {
+
+bool execAll(QSqlQuery& query, const QStringList& statements) {
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool columnExists(QSqlQuery& query, const QString& table, const QString& column) {
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        return false;
+    }
+    while (query.next()) {
+        if (query.value("name").toString() == column) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool addColumnIfMissing(QSqlQuery& query, const QString& table,
+                        const QString& column, const QString& definition) {
+    if (columnExists(query, table, column)) {
+        return true;
+    }
+    return query.exec(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition));
+}
+
+} // namespace
+
+SchemaMigrator::SchemaMigrator(const QSqlDatabase& database)
+    : m_database(database)
+{
+}
+
+const QVector<SchemaMigrator::Migration>& SchemaMigrator::migrations() {
+    static const QVector<Migration> list = {
+        { 1, "Baseline schema", [](QSqlQuery& query) {
+            bool ok = execAll(query, {
+                R"(
+                    CREATE TABLE IF NOT EXISTS users (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        username TEXT UNIQUE NOT NULL,
+                        password_hash TEXT NOT NULL,
+                        name TEXT NOT NULL,
+                        surname TEXT NOT NULL,
+                        email TEXT UNIQUE NOT NULL,
+                        contact_no TEXT,
+                        school_name TEXT,
+                        role TEXT NOT NULL,
+                        security_question TEXT NOT NULL,
+                        security_answer TEXT NOT NULL,
+                        created_at DATETIME DEFAULT CURRENT_TIMESTAMP
+                    )
+                )",
+                R"(
+                    CREATE TABLE IF NOT EXISTS learners (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        name TEXT NOT NULL,
+                        surname TEXT NOT NULL,
+                        grade TEXT NOT NULL,
+                        date_of_birth DATE NOT NULL,
+                        contact_no TEXT,
+                        created_at DATETIME DEFAULT CURRENT_TIMESTAMP
+                    )
+                )",
+                R"(
+                    CREATE TABLE IF NOT EXISTS books (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        book_code TEXT UNIQUE NOT NULL,
+                        isbn TEXT NOT NULL,
+                        title TEXT NOT NULL,
+                        author TEXT NOT NULL,
+                        subject TEXT NOT NULL,
+                        grade TEXT NOT NULL,
+                        price REAL NOT NULL DEFAULT 0.0,
+                        status TEXT NOT NULL DEFAULT 'Available',
+                        created_at DATETIME DEFAULT CURRENT_TIMESTAMP
+                    )
+                )",
+                R"(
+                    CREATE TABLE IF NOT EXISTS transactions (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        learner_id INTEGER NOT NULL,
+                        book_id INTEGER NOT NULL,
+                        borrow_date DATE NOT NULL,
+                        due_date DATE NOT NULL,
+                        return_date DATE,
+                        status TEXT NOT NULL DEFAULT 'Active',
+                        created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+                        FOREIGN KEY (learner_id) REFERENCES learners(id),
+                        FOREIGN KEY (book_id) REFERENCES books(id)
+                    )
+                )",
+                R"(
+                    CREATE TABLE IF NOT EXISTS user_activity_logs (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        user_id INTEGER NOT NULL,
+                        action_type TEXT NOT NULL,
+                        action_details TEXT,
+                        created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+                        FOREIGN KEY (user_id) REFERENCES users(id)
+                    )
+                )",
+                R"(
+                    CREATE TABLE IF NOT EXISTS payments (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        receipt_no TEXT UNIQUE,
+                        learner_id INTEGER,
+                        amount REAL,
+                        processed_by INTEGER,
+                        payment_date DATETIME DEFAULT CURRENT_TIMESTAMP,
+                        notes TEXT,
+                        FOREIGN KEY (learner_id) REFERENCES learners(id) ON DELETE SET NULL ON UPDATE CASCADE,
+                        FOREIGN KEY (processed_by) REFERENCES users(id) ON DELETE SET NULL ON UPDATE CASCADE
+                    )
+                )",
+                R"(
+                    CREATE TABLE IF NOT EXISTS payment_items (
+                        id INTEGER PRIMARY KEY AUTOINCREMENT,
+                        payment_id INTEGER NOT NULL,
+                        transaction_id INTEGER,
+                        book_id INTEGER,
+                        amount REAL,
+                        FOREIGN KEY (payment_id) REFERENCES payments(id) ON DELETE CASCADE ON UPDATE CASCADE,
+                        FOREIGN KEY (transaction_id) REFERENCES transactions(id) ON DELETE SET NULL ON UPDATE CASCADE,
+                        FOREIGN KEY (book_id) REFERENCES books(id) ON DELETE SET NULL ON UPDATE CASCADE
+                    )
+                )",
+                "CREATE INDEX IF NOT EXISTS idx_payments_learner_id ON payments(learner_id)",
+                "CREATE INDEX IF NOT EXISTS idx_payments_processed_by ON payments(processed_by)",
+                "CREATE INDEX IF NOT EXISTS idx_payment_items_payment_id ON payment_items(payment_id)",
+                "CREATE INDEX IF NOT EXISTS idx_payment_items_transaction_id ON payment_items(transaction_id)",
+                "CREATE INDEX IF NOT EXISTS idx_payment_items_book_id ON payment_items(book_id)"
+            });
+
+            // Older databases may already have these from the previous startup path
+            return ok
+                && addColumnIfMissing(query, "users", "password_changed_at", "DATETIME")
+                && addColumnIfMissing(query, "users", "last_login", "DATETIME");
+        }},
+        { 2, "Indexes for circulation, catalogue and learner lookups", [](QSqlQuery& query) {
+            return execAll(query, {
+                // hasOverdueBooks is fully covered; learner history and active loans seek on the prefix
+                "CREATE INDEX IF NOT EXISTS idx_transactions_learner_status_due ON transactions(learner_id, status, due_date)",
+                // Overdue lists/counts and active learner count read only this index
+                "CREATE INDEX IF NOT EXISTS idx_transactions_status_due ON transactions(status, due_date, learner_id)",
+                "CREATE INDEX IF NOT EXISTS idx_transactions_book_status ON transactions(book_id, status)",
+                "CREATE INDEX IF NOT EXISTS idx_transactions_created_at ON transactions(created_at)",
+                "CREATE INDEX IF NOT EXISTS idx_transactions_borrow_date ON transactions(borrow_date)",
+                "CREATE INDEX IF NOT EXISTS idx_books_isbn ON books(isbn)",
+                "CREATE INDEX IF NOT EXISTS idx_books_title ON books(title)",
+                "CREATE INDEX IF NOT EXISTS idx_books_grade_title ON books(grade, title)",
+                "CREATE INDEX IF NOT EXISTS idx_books_subject_title ON books(subject, title)",
+                "CREATE INDEX IF NOT EXISTS idx_books_status_title ON books(status, title)",
+                "CREATE INDEX IF NOT EXISTS idx_learners_surname_name ON learners(surname, name)",
+                "CREATE INDEX IF NOT EXISTS idx_learners_grade_surname_name ON learners(grade, surname, name)",
+                "ANALYZE"
+            });
+        }},
+        { 3, "Indexes for keyset pagination", [](QSqlQuery& query) {
+            // Title, grade and subject sorts already have indexes from migration 2
+            return execAll(query, {
+                "CREATE INDEX IF NOT EXISTS idx_books_author ON books(author)",
+                "CREATE INDEX IF NOT EXISTS idx_users_name_surname ON users(name, surname)",
+                "CREATE INDEX IF NOT EXISTS idx_transactions_learner_created ON transactions(learner_id, created_at)"
+            });
+        }},
+        { 4, "Full-text search for books and learners", [](QSqlQuery& query) {
+            if (!query.exec("SELECT sqlite_compileoption_used('ENABLE_FTS5')")
+                || !query.next() || !query.value(0).toBool()) {
+                // Search keeps working through LIKE; nothing to create
+                qWarning() << "SQLite was built without FTS5; full-text search disabled";
+                return true;
+            }
+            query.finish();
+
+            // External-content tables: the index lives in *_fts, the text stays in the
+            // base table. Triggers keep them in step; status changes don't touch the index.
+            return execAll(query, {
+                R"(
+                    CREATE VIRTUAL TABLE IF NOT EXISTS books_fts USING fts5(
+                        title, author, book_code, isbn,
+                        content = 'books', content_rowid = 'id',
+                        tokenize = 'unicode61 remove_diacritics 2',
+                        prefix = '2 3 4'
+                    )
+                )",
+                R"(
+                    CREATE TRIGGER IF NOT EXISTS books_fts_insert AFTER INSERT ON books BEGIN
+                        INSERT INTO books_fts(rowid, title, author, book_code, isbn)
+                        VALUES (new.id, new.title, new.author, new.book_code, new.isbn);
+                    END
+                )",
+                R"(
+                    CREATE TRIGGER IF NOT EXISTS books_fts_delete AFTER DELETE ON books BEGIN
+                        INSERT INTO books_fts(books_fts, rowid, title, author, book_code, isbn)
+                        VALUES ('delete', old.id, old.title, old.author, old.book_code, old.isbn);
+                    END
+                )",
+                R"(
+                    CREATE TRIGGER IF NOT EXISTS books_fts_update
+                    AFTER UPDATE OF title, author, book_code, isbn ON books BEGIN
+                        INSERT INTO books_fts(books_fts, rowid, title, author, book_code, isbn)
+                        VALUES ('delete', old.id, old.title, old.author, old.book_code, old.isbn);
+                        INSERT INTO books_fts(rowid, title, author, book_code, isbn)
+                        VALUES (new.id, new.title, new.author, new.book_code, new.isbn);
+                    END
+                )",
+                R"(
+                    CREATE VIRTUAL TABLE IF NOT EXISTS learners_fts USING fts5(
+                        name, surname,
+                        content = 'learners', content_rowid = 'id',
+                        tokenize = 'unicode61 remove_diacritics 2',
+                        prefix = '2 3 4'
+                    )
+                )",
+                R"(
+                    CREATE TRIGGER IF NOT EXISTS learners_fts_insert AFTER INSERT ON learners BEGIN
+                        INSERT INTO learners_fts(rowid, name, surname)
+                        VALUES (new.id, new.name, new.surname);
+                    END
+                )",
+                R"(
+                    CREATE TRIGGER IF NOT EXISTS learners_fts_delete AFTER DELETE ON learners BEGIN
+                        INSERT INTO learners_fts(learners_fts, rowid, name, surname)
+                        VALUES ('delete', old.id, old.name, old.surname);
+                    END
+                )",
+                R"(
+                    CREATE TRIGGER IF NOT EXISTS learners_fts_update
+                    AFTER UPDATE OF name, surname ON learners BEGIN
+                        INSERT INTO learners_fts(learners_fts, rowid, name, surname)
+                        VALUES ('delete', old.id, old.name, old.surname);
+                        INSERT INTO learners_fts(rowid, name, surname)
+                        VALUES (new.id, new.name, new.surname);
+                    END
+                )",
+                // Index the rows that already exist
+                "INSERT INTO books_fts(books_fts) VALUES ('rebuild')",
+                "INSERT INTO learners_fts(learners_fts) VALUES ('rebuild')"
+            });
+        }},
+        { 5, "Natural-key index for roster imports", [](QSqlQuery& query) {
+            // Not UNIQUE: existing data may already hold twins the import reports as ambiguous
+            return execAll(query, {
+                "CREATE INDEX IF NOT EXISTS idx_learners_natural_key "
+                "ON learners(surname COLLATE NOCASE, name COLLATE NOCASE, date_of_birth)"
+            });
+        }},
+        { 6, "Activity log history index and monthly partitions", [](QSqlQuery& query) {
+            return execAll(query, {
+                "CREATE INDEX IF NOT EXISTS idx_user_activity_logs_user_created "
+                "ON user_activity_logs(user_id, created_at)",
+                // One row per closed month ('yyyy-MM'); compressed_rows is set once the
+                // month's user_activity_logs_yyyyMM table has been packed and dropped
+                R"(
+                    CREATE TABLE IF NOT EXISTS activity_log_partitions (
+                        period TEXT PRIMARY KEY,
+                        row_count INTEGER NOT NULL DEFAULT 0,
+                        compressed_rows BLOB
+                    )
+                )"
+            });
+        }},
+        { 7, "Closing-date index for year-end archiving", [](QSqlQuery& query) {
+            // The expression must match archiveClosedTransactions() word for word
+            return execAll(query, {
+                "CREATE INDEX IF NOT EXISTS idx_transactions_status_closed "
+                "ON transactions(status, COALESCE(return_date, due_date))"
+            });
+        }},
+    };
+    return list;
+}
+
+int SchemaMigrator::latestVersion() {
+    return migrations().isEmpty() ? 0 : migrations().last().version;
+}
+
+int SchemaMigrator::currentVersion() {
+    QSqlQuery query(m_database);
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+bool SchemaMigrator::migrate() {
+    int version = currentVersion();
+    int latest = latestVersion();
+
+    if (version == latest) {
+        return true;
+    }
+
+    if (version > latest) {
+        qWarning() << "Database schema version" << version
+                   << "is newer than this build supports (" << latest << ")";
+        return true;
+    }
+
+    if (!m_database.transaction()) {
+        m_lastError = "Failed to start schema migration: " + m_database.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_database);
+
+    for (const Migration& migration : migrations()) {
+        if (migration.version <= version) {
+            continue;
+        }
+
+        if (!migration.apply(query)) {
+            m_lastError = QString("Schema migration %1 (%2) failed: %3")
+                              .arg(migration.version)
+                              .arg(migration.description, query.lastError().text());
+            m_database.rollback();
+            return false;
+        }
+
+        qDebug() << "Applied schema migration" << migration.version << migration.description;
+    }
+
+    // PRAGMA does not accept bound parameters
+    if (!query.exec(QString("PRAGMA user_version = %1").arg(latest))) {
+        m_lastError = "Failed to record schema version: " + query.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+
+    query.finish();
+
+    if (!m_database.commit()) {
+        m_lastError = "Failed to commit schema migration: " + m_database.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,36 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// Brings the schema up to date using PRAGMA user_version. Each migration runs
+// once, in order, and all pending migrations share a single transaction.
+// New tables, columns and indexes ship as new entries in migrations().
+class SchemaMigrator {
+public:
+    struct Migration {
+        int version;
+        QString description;
+        std::function<bool(QSqlQuery& query)> apply;
+    };
+
+    explicit SchemaMigrator(const QSqlDatabase& database);
+
+    bool migrate();
+    int currentVersion();
+    static int latestVersion();
+
+    QString getLastError() const { return m_lastError; }
+
+private:
+    static const QVector<Migration>& migrations();
+
+    QSqlDatabase m_database;
+    QString m_lastError;
+};
+
+#endif // SCHEMAMIGRATOR_H
@@ -0,0 +1,50 @@
+#include "StatementCache.h"
+#include <QSqlError>
+#include <QDebug>
+
+StatementCache::StatementCache(const QSqlDatabase& database)
+    : m_database(database)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+PreparedStatement StatementCache::acquire(const QString& sql) {
+    auto it = m_statements.constFind(sql);
+    if (it != m_statements.constEnd()) {
+        ++m_hits;
+        QSqlQuery* query = it.value();
+        query->finish();
+        return PreparedStatement(query);
+    }
+
+    ++m_misses;
+    QSqlQuery* query = new QSqlQuery(m_database);
+    query->setForwardOnly(true);
+
+    if (!query->prepare(sql)) {
+        qWarning() << "StatementCache: failed to prepare statement:" << query->lastError().text();
+        // Freed with its handle, so an outer failed statement stays valid
+        return PreparedStatement(query, true);
+    }
+
+    m_statements.insert(sql, query);
+    return PreparedStatement(query);
+}
+
+void StatementCache::clear() {
+    qDeleteAll(m_statements);
+    m_statements.clear();
+}
+
+StatementCache::Stats StatementCache::stats() const {
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.size = m_statements.size();
+    return stats;
+}
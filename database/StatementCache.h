@@ -0,0 +1,74 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QHash>
+#include <QString>
+
+// Scoped handle to a cached statement. Resets the statement when it goes out
+// of scope so SQLite releases its read cursor, but keeps the compiled plan.
+// A statement that failed to prepare is not cached; the handle owns it.
+class PreparedStatement {
+public:
+    explicit PreparedStatement(QSqlQuery* query, bool owned = false) : m_query(query), m_owned(owned) {}
+    PreparedStatement(PreparedStatement&& other) noexcept : m_query(other.m_query), m_owned(other.m_owned) {
+        other.m_query = nullptr;
+        other.m_owned = false;
+    }
+    ~PreparedStatement() {
+        reset();
+        if (m_owned) {
+            delete m_query;
+        }
+    }
+
+    QSqlQuery& operator*() const { return *m_query; }
+    QSqlQuery* operator->() const { return m_query; }
+
+    // Release the cursor early (e.g. before COMMIT)
+    void reset() {
+        if (m_query) {
+            m_query->finish();
+        }
+    }
+
+private:
+    PreparedStatement(const PreparedStatement&) = delete;
+    PreparedStatement& operator=(const PreparedStatement&) = delete;
+
+    QSqlQuery* m_query;
+    bool m_owned;
+};
+
+// Keeps prepared statements alive for the lifetime of one connection, keyed by
+// their SQL text, so each statement is parsed and planned only once.
+class StatementCache {
+public:
+    struct Stats {
+        int hits = 0;
+        int misses = 0;
+        int size = 0;
+    };
+
+    explicit StatementCache(const QSqlDatabase& database);
+    ~StatementCache();
+
+    // Returns a prepared statement ready for binding. If prepare fails the
+    // statement is not cached and its lastError() describes the failure.
+    PreparedStatement acquire(const QString& sql);
+
+    void clear();
+    Stats stats() const;
+
+private:
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    QSqlDatabase m_database;
+    QHash<QString, QSqlQuery*> m_statements;
+    int m_hits;
+    int m_misses;
+};
+
+#endif // STATEMENTCACHE_H
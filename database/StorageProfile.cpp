@@ -0,0 +1,79 @@
+#include "StorageProfile.h"
+
+StorageProfile StorageProfile::deskLaptop() {
+    StorageProfile profile;
+    profile.name = "desk laptop";
+    profile.walJournal = true;
+    profile.synchronous = Synchronous::Normal;
+    profile.cacheSizeKiB = 64 * 1024;
+    profile.mmapSizeBytes = 256LL * 1024 * 1024;
+    profile.tempStoreInMemory = true;
+    profile.pageSize = 4096;
+    profile.walAutoCheckpointPages = 1000;
+    profile.busyTimeoutMs = 5000;
+    return profile;
+}
+
+StorageProfile StorageProfile::lowRamKiosk() {
+    StorageProfile profile;
+    profile.name = "low-RAM kiosk";
+    profile.walJournal = true;
+    profile.synchronous = Synchronous::Normal;
+    profile.cacheSizeKiB = 2 * 1024;
+    profile.mmapSizeBytes = 0;
+    profile.tempStoreInMemory = false;
+    profile.pageSize = 4096;
+    profile.walAutoCheckpointPages = 500;
+    profile.busyTimeoutMs = 5000;
+    return profile;
+}
+
+StorageProfile StorageProfile::bulkImport() {
+    StorageProfile profile;
+    profile.name = "bulk import";
+    profile.walJournal = true;
+    profile.synchronous = Synchronous::Off;
+    profile.cacheSizeKiB = 256 * 1024;
+    profile.mmapSizeBytes = 512LL * 1024 * 1024;
+    profile.tempStoreInMemory = true;
+    profile.pageSize = 8192;
+    // Rare, large checkpoints (about 80 MiB of WAL) rather than none, so the
+    // WAL stays bounded for the rest of the session
+    profile.walAutoCheckpointPages = 10000;
+    profile.busyTimeoutMs = 30000;
+    return profile;
+}
+
+StorageProfile StorageProfile::fromName(const QString& name) {
+    QString key = name.trimmed().toLower();
+    if (key == "low-ram kiosk") {
+        return lowRamKiosk();
+    }
+    if (key == "bulk import") {
+        return bulkImport();
+    }
+    return deskLaptop();
+}
+
+QStringList StorageProfile::presetNames() {
+    return {"desk laptop", "low-RAM kiosk", "bulk import"};
+}
+
+QString StorageProfile::synchronousToString(Synchronous synchronous) {
+    switch (synchronous) {
+        case Synchronous::Off: return "OFF";
+        case Synchronous::Normal: return "NORMAL";
+        case Synchronous::Full: return "FULL";
+        default: return "FULL";
+    }
+}
+
+QString StorageProfile::checkpointToString(Checkpoint mode) {
+    switch (mode) {
+        case Checkpoint::Passive: return "PASSIVE";
+        case Checkpoint::Full: return "FULL";
+        case Checkpoint::Restart: return "RESTART";
+        case Checkpoint::Truncate: return "TRUNCATE";
+        default: return "PASSIVE";
+    }
+}
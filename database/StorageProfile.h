@@ -0,0 +1,47 @@
+#ifndef STORAGEPROFILE_H
+#define STORAGEPROFILE_H
+
+#include <QString>
+#include <QStringList>
+
+// SQLite settings applied to every connection when it is opened.
+// Presets cover the machines we deploy on; fields can be tuned individually.
+struct StorageProfile {
+    enum class Synchronous {
+        Off,        // No fsync at all - only for re-runnable bulk loads
+        Normal,     // WAL: durable across app crashes, may lose last commit on power loss
+        Full        // fsync on every commit
+    };
+
+    enum class Checkpoint {
+        Passive,    // Copy what it can without blocking readers or writers
+        Full,       // Wait for writers, then copy everything
+        Restart,    // Full, then make the next writer restart the WAL
+        Truncate    // Restart, then truncate the WAL file to zero bytes
+    };
+
+    QString name;
+    bool walJournal;
+    Synchronous synchronous;
+    int cacheSizeKiB;           // PRAGMA cache_size (negative = KiB)
+    qint64 mmapSizeBytes;       // 0 disables memory-mapped I/O
+    bool tempStoreInMemory;
+    int pageSize;               // Only takes effect on a new, empty database
+    int walAutoCheckpointPages; // 0 disables automatic checkpoints
+    int busyTimeoutMs;
+
+    static StorageProfile deskLaptop();
+    static StorageProfile lowRamKiosk();
+    // Only for a session spent loading data that can be loaded again:
+    // synchronous=OFF risks the database on a power cut. Not for everyday use.
+    static StorageProfile bulkImport();
+
+    // Looks up a preset by name (case-insensitive); falls back to deskLaptop()
+    static StorageProfile fromName(const QString& name);
+    static QStringList presetNames();
+
+    static QString synchronousToString(Synchronous synchronous);
+    static QString checkpointToString(Checkpoint mode);
+};
+
+#endif // STORAGEPROFILE_H
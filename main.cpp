@@ -1,8 +1,14 @@
 #include "MainWindow.h"
 #include "DatabaseManager.h"
+#include "AsyncDatabase.h"
+#include "BackupService.h"
+#include "ActivityLogger.h"
+#include "LibraryStatistics.h"
+#include "DomainEvents.h"
 #include <QApplication>
 #include <QMessageBox>
 #include <QFile>
+#include <QSettings>
 
 
 int main(int argc, char *argv[])
@@ -26,17 +32,81 @@ int main(int argc, char *argv[])
 
     
     // Initialize database
-    if (!DatabaseManager::instance().initialize("library_system.db")) {
+    // Storage profile: "desk laptop" (default), "low-RAM kiosk" or "bulk import"
+    QSettings settings;
+    StorageProfile profile = StorageProfile::fromName(
+        settings.value("database/storageProfile", "desk laptop").toString());
+
+    // Entries kept per entity type by the book/learner/user lookup cache
+    DatabaseManager::instance().setEntityCacheCapacity(
+        settings.value("database/entityCacheCapacity", DatabaseManager::kDefaultEntityCacheCapacity).toInt());
+
+    // Created here so the event bus lives on the GUI thread whoever publishes first
+    DomainEvents::instance();
+
+    // A restore chosen in Settings is swapped in before anything opens the file
+    QString restoreError;
+    // Stop rather than open whatever a failed swap left at the database path
+    if (!BackupService::applyPendingRestore("library_system.db", &restoreError)) {
+        QMessageBox::critical(nullptr, "Restore Failed",
+                              "The staged backup could not be restored:\n" + restoreError);
+
+        return 1;
+    }
+
+    if (!DatabaseManager::instance().initialize("library_system.db", profile)) {
         QMessageBox::critical(nullptr, "Database Error",
                             "Failed to initialize database:\n" +
                             DatabaseManager::instance().getLastError());
 
         return 1;
     }
+
+    // Audit entries are committed in batches: every flushIntervalMs, or sooner
+    // once batchSize are waiting; loggers block if capacity are still unwritten
+    ActivityLogger::Options logOptions;
+    logOptions.flushIntervalMs = settings.value("activityLog/flushIntervalMs", logOptions.flushIntervalMs).toInt();
+    logOptions.batchSize = settings.value("activityLog/batchSize", logOptions.batchSize).toInt();
+    logOptions.capacity = settings.value("activityLog/capacity", logOptions.capacity).toInt();
+    ActivityLogger::instance().start(logOptions);
+
+    // Closed months of the activity log leave the live table at startup; months
+    // older than this are compressed (0 keeps them as plain tables)
+    AsyncDatabase::instance().rollActivityLogPartitions(settings.value("activityLog/keepMonths", 12).toInt());
+
+    // Returned and Paid loans closed more than this many months ago move to the
+    // archive file in the background at startup; 0 keeps everything live
+    int archiveAfterMonths = settings.value("database/archiveClosedAfterMonths", 0).toInt();
+    if (archiveAfterMonths > 0) {
+        AsyncDatabase::instance().archiveClosedTransactions(QDate::currentDate().addMonths(-archiveAfterMonths));
+    }
+
+    // Dashboard counters: counted once now, then kept current by every change;
+    // a recount every this many minutes checks them for drift (0 = never).
+    // Created here first so its reconcile timer lives on the GUI thread.
+    LibraryStatistics::instance();
+    AsyncDatabase::instance().run<bool>([](DatabaseManager&) {
+        return LibraryStatistics::instance().seed();
+    });
+    LibraryStatistics::instance().setReconcileInterval(settings.value("statistics/reconcileMinutes", 30).toInt());
+
+    // Online backups: kept generations, hours between backups (0 = manual only)
+    // and target folder, which defaults to "backups" next to the database
+    BackupService::instance().setBackupDirectory(settings.value("backup/directory").toString());
+    BackupService::instance().setGenerations(settings.value("backup/generations", 7).toInt());
+    BackupService::instance().setSchedule(settings.value("backup/intervalHours", 24).toInt());
     
     // Create and show main window
     MainWindow w;
     w.showMaximized();
     
-    return a.exec();
+    int result = a.exec();
+
+    // Finish background queries and queued audit entries before their
+    // connections go away
+    AsyncDatabase::instance().shutdown();
+    ActivityLogger::instance().shutdown();
+    DatabaseManager::instance().closeDatabase();
+
+    return result;
 }
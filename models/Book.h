@@ -67,4 +67,31 @@ private:
     QDateTime m_createdAt;
 };
 
+// Columns shown in book lists; skips the ISBN and timestamp a full Book carries
+struct BookListRow {
+    int id;
+    QString bookCode;
+    QString title;
+    QString author;
+    QString subject;
+    QString grade;
+    double price;
+    Book::Status status;
+
+    BookListRow() : id(-1), price(0.0), status(Book::Status::Available) {}
+
+    static BookListRow fromBook(const Book& book) {
+        BookListRow row;
+        row.id = book.getId();
+        row.bookCode = book.getBookCode();
+        row.title = book.getTitle();
+        row.author = book.getAuthor();
+        row.subject = book.getSubject();
+        row.grade = book.getGrade();
+        row.price = book.getPrice();
+        row.status = book.getStatus();
+        return row;
+    }
+};
+
 #endif // BOOK_H
\ No newline at end of file
@@ -66,4 +66,19 @@ private:
     QDateTime m_createdAt;
 };
 
+// A transaction with the book and learner columns that circulation tables
+// show, loaded in one JOIN
+struct TransactionDetail {
+    Transaction transaction;
+    QString bookCode;
+    QString bookTitle;
+    double bookPrice;
+    QString learnerName;
+    QString learnerSurname;
+
+    TransactionDetail() : bookPrice(0.0) {}
+
+    QString learnerFullName() const { return learnerName + " " + learnerSurname; }
+};
+
 #endif // TRANSACTION_H
@@ -78,4 +78,17 @@ struct UserActivityLog {
 
     UserActivityLog() : id(-1), userId(-1) {}
 };
+
+// Columns shown in user lists; never carries password or security answer
+struct UserListRow {
+    int id;
+    QString username;
+    QString name;
+    QString surname;
+    QString email;
+    QString contactNo;
+    User::Role role;
+
+    UserListRow() : id(-1), role(User::Role::Librarian) {}
+};
 #endif // USER_H
@@ -2,6 +2,7 @@
 #include "ui_MainWindow.h"
 #include "AuthManager.h"
 #include "DatabaseManager.h"
+#include "AsyncDatabase.h"
 #include <QMessageBox>
 #include <QDate>
 #include <QPrinter>
@@ -13,6 +14,24 @@
 #include <QDateTime>
 #include <QFile>
 #include <QIcon>
+#include <QScrollBar>
+#include <QProgressDialog>
+#include <QFileInfo>
+#include <QHeaderView>
+
+namespace {
+
+// Ids referenced by a list of transactions, for one batched lookup per table
+QVector<int> bookIdsOf(const QVector<Transaction>& transactions) {
+    QVector<int> ids;
+    ids.reserve(transactions.size());
+    for (const Transaction& trans : transactions) {
+        ids.append(trans.getBookId());
+    }
+    return ids;
+}
+
+}
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -22,6 +41,17 @@ MainWindow::MainWindow(QWidget *parent)
     , m_selectedTransactionId(-1)
     , m_menuExpanded(true)
     , m_chartView(nullptr)
+    , m_recentRequest(0)
+    , m_bookSort(DatabaseManager::BookSort::Title)
+    , m_historyLearnerId(-1)
+    , m_bookModel(new BookTableModel(this))
+    , m_learnerModel(new LearnerTableModel(this))
+    , m_historyModel(new TransactionTableModel(this))
+    , m_lostBookModel(new LostBookTableModel(this))
+    , m_userModel(new UserTableModel(this))
+    , m_returnScanQueue(new ReturnScanQueue(this))
+    , m_scanAccepted(0)
+    , m_scanRejected(0)
 {
     ui->setupUi(this);
     initializeUI();
@@ -105,22 +135,68 @@ void MainWindow::initializeUI() {
     m_currentPaymentId = -1;
     ui->pushButton_viewReceipt->setEnabled(false);
 
-    // Setup lost books table
-    ui->tableWidget_lostBooks->setColumnCount(6);
-    ui->tableWidget_lostBooks->setHorizontalHeaderLabels({
-        "Transaction ID", "Book Code", "Book Title", "Lost Date", "Amount", "Select"
-    });
-    ui->tableWidget_lostBooks->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableWidget_lostBooks->horizontalHeader()->setStretchLastSection(true);
-
-
 }
 
 void MainWindow::setupConnections() {
 
-    // Payment table item changed
-    connect(ui->tableWidget_lostBooks, &QTableWidget::itemChanged,
-            this, &MainWindow::updatePaymentSummary);
+    // Payment table check boxes
+    connect(m_lostBookModel, &QAbstractItemModel::dataChanged, this, &MainWindow::updatePaymentSummary);
+    connect(m_lostBookModel, &QAbstractItemModel::modelReset, this, &MainWindow::updatePaymentSummary);
+
+    // Streaming tables fetch their next page themselves (fetchMore). Their
+    // scrollbar only spans the loaded rows; its tooltip tells how many the
+    // whole listing is expected to have.
+    auto trackRowEstimate = [this](QTableView* table, auto* model) {
+        auto update = [table, model]() {
+            const int loaded = model->rowCount();
+            const int estimate = model->estimatedRowCount();
+            QString text;
+            if (!model->hasMore()) {
+                text = QString("%1 rows").arg(loaded);
+            } else if (estimate > loaded) {
+                text = QString("%1 of about %2 rows loaded").arg(loaded).arg(estimate);
+            } else {
+                text = QString("%1 rows loaded, more on scrolling").arg(loaded);
+            }
+            table->verticalScrollBar()->setToolTip(text);
+        };
+        connect(model, &QAbstractItemModel::modelReset, this, update);
+        connect(model, &QAbstractItemModel::rowsInserted, this, update);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, update);
+    };
+    trackRowEstimate(ui->tableView_books, m_bookModel);
+    trackRowEstimate(ui->tableView_viewLearnersList, m_learnerModel);
+    trackRowEstimate(ui->tableView_transactionHistory, m_historyModel);
+
+    // Continuous return mode: scanners finish each code with Enter
+    connect(ui->lineEdit_returnSearch, &QLineEdit::returnPressed, this, [this]() {
+        if (ui->radioButton_continuousScan->isChecked()) {
+            m_returnScanQueue->enqueue(ui->lineEdit_returnSearch->text(), ui->dateEdit_returnDate->date());
+            ui->lineEdit_returnSearch->clear();
+        }
+    });
+    connect(m_returnScanQueue, &ReturnScanQueue::scanProcessed, this, &MainWindow::appendScanLedger);
+    connect(m_returnScanQueue, &ReturnScanQueue::pendingCountChanged, this, &MainWindow::updateScanSummary);
+
+    // Scheduled backups report here as well as ones started from Settings
+    connect(&BackupService::instance(), &BackupService::backupProgress, this, [this](int percent) {
+        ui->label_backupStatus->setText(QString("Backing up... %1%").arg(percent));
+    });
+    connect(&BackupService::instance(), &BackupService::backupFinished, this, &MainWindow::updateBackupStatus);
+    updateBackupStatus(BackupService::Result());
+
+    // Committed changes from any page, batched per event-loop pass
+    connect(&DomainEvents::instance(), &DomainEvents::changed, this, &MainWindow::onDomainChanges);
+
+    // The user list loads whenever the admin page comes up
+    QStackedWidget* usersStack = qobject_cast<QStackedWidget*>(ui->page_userProfile->parentWidget());
+    if (usersStack) {
+        connect(usersStack, &QStackedWidget::currentChanged, this, [this, usersStack]() {
+            if (usersStack->currentWidget()->isAncestorOf(ui->tableView_users)) {
+                loadUsers();
+            }
+        });
+    }
 }
 
 void MainWindow::setupComboBoxes(){
@@ -177,38 +253,46 @@ void MainWindow::setupComboBoxes(){
 }
 
 void MainWindow::setupTableHeaders() {
-    // Books table
-    ui->tableWidget_books->setColumnCount(8);
-    ui->tableWidget_books->setHorizontalHeaderLabels({
-        "ID", "Book Code", "Title", "Author", "Subject", "Grade", "Price", "Status"
-    });
-    ui->tableWidget_books->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableWidget_books->setSelectionMode(QAbstractItemView::SingleSelection);
-    ui->tableWidget_books->horizontalHeader()->setStretchLastSection(true);
-    ui->tableWidget_books->setColumnHidden(0, true);
-    ui->tableWidget_books->setColumnHidden(3, true);
-    ui->tableWidget_books->setColumnHidden(6, true);
+    // Listing tables are views over models; headers come from the model.
+    // Sorting starts off so rows first show in the order they were queried.
+    auto setupListing = [](QTableView* table, QAbstractItemModel* model) {
+        table->setModel(model);
+        table->setSelectionBehavior(QAbstractItemView::SelectRows);
+        table->horizontalHeader()->setStretchLastSection(true);
+        table->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+        table->setSortingEnabled(true);
+        // Rows never wrap, so the view need not measure each one
+        table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    };
 
+    // Books table
+    setupListing(ui->tableView_books, m_bookModel);
+    ui->tableView_books->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->tableView_books->setColumnHidden(0, true);
+    ui->tableView_books->setColumnHidden(3, true);
+    ui->tableView_books->setColumnHidden(6, true);
 
     // Learners table
-    ui->tableWidget_viewLearnersList->setColumnCount(6);
-    ui->tableWidget_viewLearnersList->setHorizontalHeaderLabels({
-        "ID", "Name", "Surname", "Grade", "DOB", "Contact"
-    });
+    setupListing(ui->tableView_viewLearnersList, m_learnerModel);
+    ui->tableView_viewLearnersList->setSelectionMode(QAbstractItemView::SingleSelection);
 
-    ui->tableWidget_viewLearnersList->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableWidget_viewLearnersList->setSelectionMode(QAbstractItemView::SingleSelection);
-    ui->tableWidget_viewLearnersList->horizontalHeader()->setStretchLastSection(true);
-    ui->tableWidget_viewLearnersList->setColumnHidden(0, false); // Hide ID column
-    
     // Transactions table
-    ui->tableWidget_transactionHistory->setColumnCount(7);
-    ui->tableWidget_transactionHistory->setHorizontalHeaderLabels({
-        "ID", "Book Title", "Borrow Date", "Due Date", "Return Date", "Status", "Days Overdue"
+    setupListing(ui->tableView_transactionHistory, m_historyModel);
+
+    // Lost books (payments)
+    setupListing(ui->tableView_lostBooks, m_lostBookModel);
+
+    // Users (admin)
+    setupListing(ui->tableView_users, m_userModel);
+    ui->tableView_users->setSelectionMode(QAbstractItemView::SingleSelection);
+    
+    // Continuous return scan ledger
+    ui->tableWidget_scanLedger->setColumnCount(4);
+    ui->tableWidget_scanLedger->setHorizontalHeaderLabels({
+        "Time", "Book Code", "Result", "Details"
     });
-    ui->tableWidget_transactionHistory->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableWidget_transactionHistory->horizontalHeader()->setStretchLastSection(true);
-    ui->tableWidget_transactionHistory->setColumnHidden(0, false);
+    ui->tableWidget_scanLedger->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableWidget_scanLedger->horizontalHeader()->setStretchLastSection(true);
     
     // Return books table
     ui->tableWidget_returnBooks->setColumnCount(6);
@@ -575,23 +659,72 @@ void MainWindow::showSettingsPage(){
 void MainWindow::loadDashboardData() {
     updateDashboardStats();
     loadRecentTransactions();
-    setupLibraryChart();
 }
 
 void MainWindow::updateDashboardStats() {
-    auto stats = DatabaseManager::instance().getDashboardStats();
-    
-    ui->label_totalBooksDisplay->setText(QString::number(stats.totalBooks));
-    ui->label_booksAvailableDisplay->setText(QString::number(stats.availableBooks));
-    ui->label_BooksCurrentlyBorrowedDisplay->setText(QString::number(stats.borrowedBooks));
-    ui->label_totalActiveLearnersDisplay->setText(QString::number(stats.activeLearners));
-    ui->label_totalUsersDisplay->setText(QString::number(stats.totalUsers));
-    ui->label_unreturnedBooksDisplay->setText(QString::number(stats.overdueBooks));
+    auto future = AsyncDatabase::instance().getDashboardStats();
+    future.then(this, [this](const DatabaseManager::DashboardStats& stats) {
+        ui->label_totalBooksDisplay->setText(QString::number(stats.totalBooks));
+        ui->label_booksAvailableDisplay->setText(QString::number(stats.availableBooks));
+        ui->label_BooksCurrentlyBorrowedDisplay->setText(QString::number(stats.borrowedBooks));
+        ui->label_totalActiveLearnersDisplay->setText(QString::number(stats.activeLearners));
+        ui->label_totalUsersDisplay->setText(QString::number(stats.totalUsers));
+        ui->label_unreturnedBooksDisplay->setText(QString::number(stats.overdueBooks));
+        setupLibraryChart(stats);
+    });
+}
+
+// Keeps open pages current without reloading them: deleted rows go, changed
+// rows that are loaded are re-read and replaced in their model. Added rows
+// are left to the page that added them, which reloads to place them in order.
+void MainWindow::onDomainChanges(const DomainChanges& changes) {
+    m_bookModel->removeIds(changes.deletedBooks);
+    m_learnerModel->removeIds(changes.deletedLearners);
+
+    const QVector<int> bookIds = m_bookModel->loadedIds(changes.changedBooks);
+    if (!bookIds.isEmpty()) {
+        auto future = AsyncDatabase::instance().run<QHash<int, Book>>([bookIds](DatabaseManager& db) {
+            return db.getBooksByIds(bookIds);
+        });
+        future.then(this, [this](const QHash<int, Book>& books) {
+            // Rows the table dropped meanwhile are skipped
+            for (const Book& book : books) {
+                m_bookModel->updateRow(BookListRow::fromBook(book));
+            }
+        });
+    }
+
+    const QVector<int> learnerIds = m_learnerModel->loadedIds(changes.changedLearners);
+    if (!learnerIds.isEmpty()) {
+        auto future = AsyncDatabase::instance().run<QHash<int, Learner>>([learnerIds](DatabaseManager& db) {
+            return db.getLearnersByIds(learnerIds);
+        });
+        future.then(this, [this](const QHash<int, Learner>& learners) {
+            for (const Learner& learner : learners) {
+                m_learnerModel->updateRow(learner);
+            }
+        });
+    }
+
+    // Hidden pages load fresh when navigated to
+    if (ui->page_dashboard->isVisible()) {
+        loadDashboardData();
+    }
+    if (ui->page_profile->isVisible() && changes.changedLearners.contains(m_selectedLearnerId)) {
+        loadLearnerProfile(m_selectedLearnerId);
+    }
 }
 
 void MainWindow::loadRecentTransactions() {
-    QVector<Transaction> transactions = DatabaseManager::instance().getRecentTransactions(10);
-    populateDashboardTransactions(transactions);
+    m_recentFuture.cancel();
+    m_recentFuture = AsyncDatabase::instance().getRecentTransactionDetails(10);
+
+    int request = ++m_recentRequest;
+    m_recentFuture.then(this, [this, request](const QVector<TransactionDetail>& transactions) {
+        if (request == m_recentRequest) {
+            populateDashboardTransactions(transactions);
+        }
+    });
 }
 
 void MainWindow::on_pushButton_addBookQuickButton_clicked() {
@@ -606,21 +739,9 @@ void MainWindow::on_pushButton_issueBookQuickButton_clicked() {
 void MainWindow::on_pushButton_returnBookQuickButton_clicked() {
     showReturnBookPage();
 }
-void MainWindow::setupLibraryChart() {
-    // 1. Fetch data from database
-    int lost = 0, borrowed = 0, available = 0;
-
-    QSqlQuery query;
-    if (query.exec("SELECT status, COUNT(*) FROM books GROUP BY status")) {
-        while (query.next()) {
-            QString status = query.value(0).toString();
-            int count = query.value(1).toInt();
-
-            if (status == "Lost") lost = count;
-            else if (status == "Borrowed") borrowed = count;
-            else if (status == "Available") available = count;
-        }
-    }
+void MainWindow::setupLibraryChart(const DatabaseManager::DashboardStats& stats) {
+    // 1. Counts come from the same in-memory statistics as the labels
+    int lost = stats.lostBooks, borrowed = stats.borrowedBooks, available = stats.availableBooks;
 
     // 2. Create Pie Series
     QPieSeries *series = new QPieSeries();
@@ -780,7 +901,6 @@ void MainWindow::on_pushButton_markAsLost_clicked() {
             if (trans.isActive()) {
                 if (DatabaseManager::instance().markBookAsLost(trans.getId())) {
                     showSuccessMessage("Book marked as lost");
-                    loadAllBooks();
                 } else {
                     showErrorMessage(DatabaseManager::instance().getLastError());
                 }
@@ -795,12 +915,20 @@ void MainWindow::on_lineEdit_searchBooks_textChanged(const QString &text) {
 }
 
 void MainWindow::on_comboBox_sortBooks_currentIndexChanged(int index) {
-    loadAllBooks(); // For now, reload all books
-    // TODO: Implement sorting logic
+    // Items: Title, Author, Grade, Subject
+    switch (index) {
+        case 1: m_bookSort = DatabaseManager::BookSort::Author; break;
+        case 2: m_bookSort = DatabaseManager::BookSort::GradeTitle; break;
+        case 3: m_bookSort = DatabaseManager::BookSort::SubjectTitle; break;
+        default: m_bookSort = DatabaseManager::BookSort::Title; break;
+    }
+    // The list comes back in this order; a header sort would override it
+    ui->tableView_books->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    loadAllBooks();
 }
 
-void MainWindow::on_tableWidget_books_cellClicked(int row, int column) {
-    m_selectedBookId = ui->tableWidget_books->item(row, 0)->text().toInt();
+void MainWindow::on_tableView_books_clicked(const QModelIndex& index) {
+    m_selectedBookId = m_bookModel->idAt(index.row());
 }
 
 // Update Book
@@ -825,7 +953,6 @@ void MainWindow::on_pushButton_saveChanges_clicked() {
     if (DatabaseManager::instance().updateBook(book)) {
         showSuccessMessage("Book updated successfully!");
         showAddBookPage();
-        loadAllBooks();
         m_selectedBookId = -1;
     } else {
         showErrorMessage(DatabaseManager::instance().getLastError());
@@ -857,7 +984,6 @@ void MainWindow::on_pushButton_deleteBook_clicked() {
         if (DatabaseManager::instance().deleteBook(m_selectedBookId)) {
             showSuccessMessage("Book deleted successfully!");
             showAddBookPage();
-            loadAllBooks();
             m_selectedBookId = -1;
         } else {
             showErrorMessage(DatabaseManager::instance().getLastError());
@@ -946,8 +1072,8 @@ void MainWindow::on_comboBox_filterLearnerGrade_currentIndexChanged(int index) {
     }
 }
 
-void MainWindow::on_tableWidget_viewLearnersList_cellClicked(int row, int column) {
-    m_selectedLearnerId = ui->tableWidget_viewLearnersList->item(row, 0)->text().toInt();
+void MainWindow::on_tableView_viewLearnersList_clicked(const QModelIndex& index) {
+    m_selectedLearnerId = m_learnerModel->idAt(index.row());
 }
 
 // Learner Profile
@@ -997,7 +1123,6 @@ void MainWindow::on_pushButton_editLearnerConfirm_clicked() {
     if (DatabaseManager::instance().updateLearner(learner)) {
         showSuccessMessage("Learner updated successfully!");
         showAddLearnerPage();
-        loadAllLearners();
         m_selectedLearnerId = -1;
     } else {
         showErrorMessage(DatabaseManager::instance().getLastError());
@@ -1125,6 +1250,12 @@ void MainWindow::on_radioButton_searchByBook_clicked() {
     ui->label_searchBy->setText("Enter Book Code:");
 }
 
+void MainWindow::on_radioButton_continuousScan_clicked() {
+    ui->label_searchBy->setText("Scan Book Codes:");
+    ui->lineEdit_returnSearch->clear();
+    ui->lineEdit_returnSearch->setFocus();
+}
+
 void MainWindow::on_pushButton_searchReturn_clicked() {
     QString searchText = ui->lineEdit_returnSearch->text().trimmed();
     
@@ -1133,7 +1264,11 @@ void MainWindow::on_pushButton_searchReturn_clicked() {
         return;
     }
     
-    if (ui->radioButton_searchByLearner->isChecked()) {
+    if (ui->radioButton_continuousScan->isChecked()) {
+        m_returnScanQueue->enqueue(searchText, ui->dateEdit_returnDate->date());
+        ui->lineEdit_returnSearch->clear();
+        ui->lineEdit_returnSearch->setFocus();
+    } else if (ui->radioButton_searchByLearner->isChecked()) {
         bool ok;
         int learnerId = searchText.toInt(&ok);
         
@@ -1199,22 +1334,35 @@ void MainWindow::on_pushButton_filterHistory_clicked() {
     QDate startDate = ui->dateEdit_filterFrom->date();
     QDate endDate = ui->dateEdit_filterTo->date();
     
-    QVector<Transaction> transactions = DatabaseManager::instance().getTransactionsByLearnerId(m_selectedLearnerId);
+    QVector<TransactionDetail> transactions =
+        DatabaseManager::instance().getTransactionDetailsByLearner(m_selectedLearnerId, historyScope());
     
     // Filter by date range and status
-    QVector<Transaction> filtered;
+    QVector<TransactionDetail> filtered;
     QString statusFilter = ui->comboBox_filterStatus->currentText();
     
-    for (const Transaction& trans : transactions) {
+    for (const TransactionDetail& detail : transactions) {
+        const Transaction& trans = detail.transaction;
         bool dateMatch = trans.getBorrowDate() >= startDate && trans.getBorrowDate() <= endDate;
         bool statusMatch = (statusFilter == "All") || (trans.getStatusString() == statusFilter);
         
         if (dateMatch && statusMatch) {
-            filtered.append(trans);
+            filtered.append(detail);
         }
     }
     
-    populateTransactionsTable(filtered);
+    // The filtered view is complete; setting it stops paging the unfiltered history
+    m_historyModel->setRows(filtered);
+}
+
+void MainWindow::on_checkBox_includeArchived_toggled(bool checked) {
+    streamTransactionHistory();
+}
+
+// Archived loans are only read when the user asks for them
+DatabaseManager::HistoryScope MainWindow::historyScope() const {
+    return ui->checkBox_includeArchived->isChecked() ? DatabaseManager::HistoryScope::Full
+                                                     : DatabaseManager::HistoryScope::Current;
 }
 
 void MainWindow::on_pushButton_goToReports_clicked() {
@@ -1304,6 +1452,171 @@ void MainWindow::on_radioButton_returnReport_clicked() {
     // Radio button selected
 }
 
+void MainWindow::on_pushButton_importBooks_clicked() {
+    QString fileName = QFileDialog::getOpenFileName(this, "Import Books From CSV", "", "CSV Files (*.csv);;All Files (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    auto* watcher = new QFutureWatcher<BookCsvImporter::Report>(this);
+    showImportProgress("Importing books...", watcher, cancelled);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        BookCsvImporter::Report report = watcher->result();
+        watcher->deleteLater();
+
+        QString summary = QString("%1 books imported from %2 rows (%3 duplicates, %4 invalid) at %5 rows/s.")
+                              .arg(report.rowsImported)
+                              .arg(report.rowsRead)
+                              .arg(report.duplicates)
+                              .arg(report.invalid)
+                              .arg(qRound(report.rowsPerSecond()));
+        if (!report.problems.isEmpty()) {
+            summary += "\n\n" + report.problems.mid(0, 10).join("\n");
+        }
+
+        if (!report.error.isEmpty()) {
+            showErrorMessage("Import stopped: " + report.error + "\n\n" + summary);
+        } else if (report.cancelled) {
+            showErrorMessage("Import cancelled.\n\n" + summary);
+        } else {
+            showSuccessMessage(summary);
+        }
+        if (report.rowsImported > 0) {
+            loadAllBooks();
+        }
+    });
+
+    watcher->setFuture(AsyncDatabase::instance().importBooksCsv(
+        fileName, BookCsvImporter::Options(), [cancelled]() { return cancelled->load(); }));
+}
+
+void MainWindow::on_pushButton_importLearners_clicked() {
+    QString fileName = QFileDialog::getOpenFileName(this, "Import Learner Roster", "", "CSV Files (*.csv);;All Files (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    auto* watcher = new QFutureWatcher<LearnerRosterImporter::Report>(this);
+    showImportProgress("Importing learner roster...", watcher, cancelled);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        LearnerRosterImporter::Report report = watcher->result();
+        watcher->deleteLater();
+
+        QString summary = QString("%1 learners added, %2 updated, %3 unchanged from %4 rows at %5 rows/s.")
+                              .arg(report.inserted)
+                              .arg(report.updated)
+                              .arg(report.unchanged)
+                              .arg(report.rowsRead)
+                              .arg(qRound(report.rowsPerSecond()));
+        if (report.duplicates + report.ambiguous + report.invalid > 0) {
+            summary += QString("\nSkipped: %1 repeated in the file, %2 ambiguous, %3 invalid.")
+                           .arg(report.duplicates)
+                           .arg(report.ambiguous)
+                           .arg(report.invalid);
+        }
+
+        // Grade moves are what staff check after a new term's roster
+        QStringList moves;
+        for (const LearnerRosterImporter::Change& change : report.changes) {
+            if (change.kind == LearnerRosterImporter::Change::Updated && change.oldGrade != change.newGrade) {
+                moves << QString("%1 %2: %3 -> %4").arg(change.name, change.surname, change.oldGrade, change.newGrade);
+                if (moves.size() == 10) {
+                    break;
+                }
+            }
+        }
+        if (!moves.isEmpty()) {
+            summary += "\n\nGrade changes:\n" + moves.join("\n");
+        }
+        if (!report.problems.isEmpty()) {
+            summary += "\n\n" + report.problems.mid(0, 10).join("\n");
+        }
+
+        if (!report.error.isEmpty()) {
+            showErrorMessage("Import stopped: " + report.error + "\n\n" + summary);
+        } else if (report.cancelled) {
+            showErrorMessage("Import cancelled.\n\n" + summary);
+        } else {
+            showSuccessMessage(summary);
+        }
+        if (report.inserted + report.updated > 0) {
+            loadAllLearners();
+        }
+    });
+
+    watcher->setFuture(AsyncDatabase::instance().importLearnerRoster(
+        fileName, LearnerRosterImporter::Options(), [cancelled]() { return cancelled->load(); }));
+}
+
+void MainWindow::on_pushButton_backupNow_clicked() {
+    if (BackupService::instance().isRunning()) {
+        showInfoMessage("A backup is already running");
+        return;
+    }
+    BackupService::instance().backupNow();
+}
+
+void MainWindow::on_pushButton_restoreBackup_clicked() {
+    QString fileName = QFileDialog::getOpenFileName(this, "Restore From Backup", BackupService::instance().backupDirectory(),
+                                                    "Database Backups (*.db)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    // The archive is restored with the database, or emptied when the backup has none
+    QString archiveNote = QFile::exists(DatabaseManager::archivePathFor(fileName))
+        ? "The transaction archive is restored from the same backup."
+        : "This backup has no transaction archive, so the current archive is set aside and "
+          "archived history starts empty.";
+
+    QMessageBox::StandardButton reply = QMessageBox::question(
+        this, "Restore From Backup",
+        "Replace the library database with this backup?\n\n" + QFileInfo(fileName).fileName() +
+        "\n\nEverything recorded since the backup was taken will be lost. " + archiveNote +
+        " The current files are kept as .before-restore files.",
+        QMessageBox::Yes | QMessageBox::No);
+    if (reply != QMessageBox::Yes) {
+        return;
+    }
+
+    QString error;
+    if (BackupService::instance().stageRestore(fileName, &error)) {
+        showInfoMessage("The backup is verified. Restart the application to complete the restore.");
+    } else {
+        showErrorMessage(error);
+    }
+}
+
+void MainWindow::updateBackupStatus(const BackupService::Result& result) {
+    if (!result.error.isEmpty()) {
+        ui->label_backupStatus->setText("Last backup failed: " + result.error);
+        return;
+    }
+    QDateTime last = BackupService::instance().lastBackupTime();
+    ui->label_backupStatus->setText(last.isValid() ? "Last backup: " + last.toString("dd/MM/yyyy HH:mm")
+                                                    : "No backups yet");
+}
+
+// Imports are stopped through the shared flag rather than QFuture::cancel(),
+// so rows committed before the cancel are still reported
+void MainWindow::showImportProgress(const QString& title, QFutureWatcherBase* watcher,
+                                    const std::shared_ptr<std::atomic_bool>& cancelled) {
+    QProgressDialog* progress = new QProgressDialog(title, "Cancel", 0, 1000, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->setAutoClose(false);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(watcher, &QFutureWatcherBase::progressTextChanged, progress, &QProgressDialog::setLabelText);
+    connect(watcher, &QFutureWatcherBase::finished, progress, &QProgressDialog::close);
+    connect(progress, &QProgressDialog::canceled, this, [cancelled]() {
+        cancelled->store(true);
+    });
+}
+
 
 // ==================== Payments ====================
 
@@ -1330,7 +1643,7 @@ void MainWindow::on_pushButton_findLearnerPayment_clicked() {
         showErrorMessage("Learner not found");
         ui->label_learnerInfo->setText("Not Found");
         ui->label_totalOutstanding->setText("R0.00");
-        ui->tableWidget_lostBooks->setRowCount(0);
+        m_lostBookModel->setRows(QVector<TransactionDetail>());
         return;
     }
 
@@ -1360,105 +1673,24 @@ void MainWindow::on_pushButton_findLearnerPayment_clicked() {
 
 // Load lost books into table
 void MainWindow::loadLostBooksForPayment(int learnerId) {
-    QVector<Transaction> lostTransactions =
-        DatabaseManager::instance().getUnpaidLostTransactionsByLearnerId(learnerId);
-
-    ui->tableWidget_lostBooks->setRowCount(0);
-    ui->tableWidget_lostBooks->setColumnCount(6);
-    ui->tableWidget_lostBooks->setHorizontalHeaderLabels({
-        "Transaction ID", "Book Code", "Book Title", "Lost Date", "Amount", "Select"
-    });
-
-    for (const Transaction& trans : lostTransactions) {
-        Book book = DatabaseManager::instance().getBookById(trans.getBookId());
-
-        int row = ui->tableWidget_lostBooks->rowCount();
-        ui->tableWidget_lostBooks->insertRow(row);
-
-        // Transaction ID
-        ui->tableWidget_lostBooks->setItem(row, 0,
-                                           new QTableWidgetItem(QString::number(trans.getId())));
-
-        // Book Code
-        ui->tableWidget_lostBooks->setItem(row, 1,
-                                           new QTableWidgetItem(book.getBookCode()));
-
-        // Book Title
-        ui->tableWidget_lostBooks->setItem(row, 2,
-                                           new QTableWidgetItem(book.getTitle()));
-
-        // Lost Date (return date when marked as lost)
-        QString lostDate = trans.getReturnDate().isValid() ?
-                               trans.getReturnDate().toString("dd/MM/yyyy") : "N/A";
-        ui->tableWidget_lostBooks->setItem(row, 3,
-                                           new QTableWidgetItem(lostDate));
-
-        // Amount
-        ui->tableWidget_lostBooks->setItem(row, 4,
-                                           new QTableWidgetItem("R" + QString::number(book.getPrice(), 'f', 2)));
-
-        // Checkbox for selection
-        QTableWidgetItem* checkboxItem = new QTableWidgetItem();
-        checkboxItem->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
-        checkboxItem->setCheckState(Qt::Unchecked);
-        ui->tableWidget_lostBooks->setItem(row, 5, checkboxItem);
-    }
-
-    ui->tableWidget_lostBooks->horizontalHeader()->setStretchLastSection(true);
-    ui->tableWidget_lostBooks->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_lostBookModel->setRows(DatabaseManager::instance().getUnpaidLostTransactionDetails(learnerId));
 }
 
-// Table selection changed - update payment summary
-void MainWindow::on_tableWidget_lostBooks_itemSelectionChanged() {
-    updatePaymentSummary();
-}
-
-// Update payment summary based on selected items
+// Update payment summary based on the checked books
 void MainWindow::updatePaymentSummary() {
-    int selectedCount = 0;
-    double totalAmount = 0.0;
-    m_selectedTransactionIds.clear();
-
-    for (int row = 0; row < ui->tableWidget_lostBooks->rowCount(); ++row) {
-        QTableWidgetItem* checkboxItem = ui->tableWidget_lostBooks->item(row, 5);
-        if (checkboxItem && checkboxItem->checkState() == Qt::Checked) {
-            selectedCount++;
-
-            // Get transaction ID
-            int transId = ui->tableWidget_lostBooks->item(row, 0)->text().toInt();
-            m_selectedTransactionIds.append(transId);
-
-            // Parse amount (remove "R" prefix)
-            QString amountStr = ui->tableWidget_lostBooks->item(row, 4)->text();
-            amountStr.remove("R");
-            totalAmount += amountStr.toDouble();
-        }
-    }
-
-    ui->label_selectedItems->setText(QString::number(selectedCount));
-    ui->label_amountToPay->setText("R" + QString::number(totalAmount, 'f', 2));
+    m_selectedTransactionIds = m_lostBookModel->selectedIds();
+    ui->label_selectedItems->setText(QString::number(m_selectedTransactionIds.size()));
+    ui->label_amountToPay->setText("R" + QString::number(m_lostBookModel->selectedAmount(), 'f', 2));
 }
 
 // Select all books
 void MainWindow::on_pushButton_selectAllBooks_clicked() {
-    for (int row = 0; row < ui->tableWidget_lostBooks->rowCount(); ++row) {
-        QTableWidgetItem* checkboxItem = ui->tableWidget_lostBooks->item(row, 5);
-        if (checkboxItem) {
-            checkboxItem->setCheckState(Qt::Checked);
-        }
-    }
-    updatePaymentSummary();
+    m_lostBookModel->setAllSelected(true);
 }
 
 // Deselect all books
 void MainWindow::on_pushButton_deselectAllBooks_clicked() {
-    for (int row = 0; row < ui->tableWidget_lostBooks->rowCount(); ++row) {
-        QTableWidgetItem* checkboxItem = ui->tableWidget_lostBooks->item(row, 5);
-        if (checkboxItem) {
-            checkboxItem->setCheckState(Qt::Unchecked);
-        }
-    }
-    updatePaymentSummary();
+    m_lostBookModel->setAllSelected(false);
 }
 
 // Process payment
@@ -1626,9 +1858,15 @@ QString MainWindow::generateReceiptHTML(const Payments& payment) {
     html += "<table>";
     html += "<tr><th>Book Code</th><th>Book Title</th><th>Amount</th></tr>";
 
+    QVector<int> bookIds;
+    for (const PaymentItem& item : items) {
+        bookIds.append(item.getBookId());
+    }
+    QHash<int, Book> books = DatabaseManager::instance().getBooksByIds(bookIds);
+
     double total = 0.0;
     for (const PaymentItem& item : items) {
-        Book book = DatabaseManager::instance().getBookById(item.getBookId());
+        Book book = books.value(item.getBookId());
         html += "<tr>";
         html += "<td>" + book.getBookCode() + "</td>";
         html += "<td>" + book.getTitle() + "</td>";
@@ -1661,7 +1899,7 @@ void MainWindow::on_pushButton_clearPayment_clicked() {
     ui->lineEdit_paymentLearnerId->clear();
     ui->label_learnerInfo->clear();
     ui->label_totalOutstanding->setText("R0.00");
-    ui->tableWidget_lostBooks->setRowCount(0);
+    m_lostBookModel->setRows(QVector<TransactionDetail>());
     ui->label_selectedItems->setText("0");
     ui->label_amountToPay->setText("R0.00");
 
@@ -1859,7 +2097,6 @@ void MainWindow::performBorrow() {
     if (DatabaseManager::instance().borrowBook(m_selectedLearnerId, m_selectedBookId, borrowDate)) {
         showSuccessMessage("Book borrowed successfully!");
         clearBorrowForm();
-        loadDashboardData();
     } else {
         showErrorMessage(DatabaseManager::instance().getLastError());
     }
@@ -1871,7 +2108,6 @@ void MainWindow::performReturn() {
     if (DatabaseManager::instance().returnBook(m_selectedTransactionId, returnDate)) {
         showSuccessMessage("Book returned successfully!");
         clearReturnForm();
-        loadDashboardData();
     } else {
         showErrorMessage(DatabaseManager::instance().getLastError());
     }
@@ -1894,7 +2130,6 @@ void MainWindow::performMarkAsLost() {
             showSuccessMessage("Book marked as lost. Learner will be charged R" +
                              QString::number(book.getPrice(), 'f', 2));
             clearReturnForm();
-            loadDashboardData();
         } else {
             showErrorMessage(DatabaseManager::instance().getLastError());
         }
@@ -1910,13 +2145,34 @@ void MainWindow::calculateAndDisplayAmount(int learnerId) {
 // ==================== Data Loading ====================
 
 void MainWindow::loadAllBooks() {
-    QVector<Book> books = DatabaseManager::instance().getAllBooks();
-    populateBooksTable(books);
+    const DatabaseManager::BookSort sort = m_bookSort;
+    m_bookModel->setQuery([sort](DatabaseManager& db, const PageCursor& after, int limit) {
+        return db.getBooksPage(sort, after, limit);
+    });
 }
 
 void MainWindow::loadAllLearners() {
-    QVector<Learner> learners = DatabaseManager::instance().getAllLearners();
-    populateLearnersTable(learners);
+    m_learnerModel->setQuery([](DatabaseManager& db, const PageCursor& after, int limit) {
+        return db.getLearnersPage(DatabaseManager::LearnerSort::Surname, after, limit);
+    });
+}
+
+void MainWindow::loadUsers() {
+    auto future = AsyncDatabase::instance().run<QVector<UserListRow>>([](DatabaseManager& db) {
+        return db.getUserList();
+    });
+    future.then(this, [this](const QVector<UserListRow>& users) {
+        m_userModel->setRows(users);
+        ui->label_summaryTitle_5->setText(QString("Showing %1 Users").arg(users.size()));
+    });
+}
+
+void MainWindow::streamTransactionHistory() {
+    const int learnerId = m_historyLearnerId;
+    const DatabaseManager::HistoryScope scope = historyScope();
+    m_historyModel->setQuery([learnerId, scope](DatabaseManager& db, const PageCursor& after, int limit) {
+        return db.getTransactionDetailsPage(after, limit, learnerId, scope);
+    });
 }
 
 void MainWindow::loadLearnerProfile(int learnerId) {
@@ -1973,108 +2229,43 @@ void MainWindow::loadTransactionHistory(int learnerId) {
     ui->label_historyLearnerName->setText(learner.getFullName());
     ui->label_historyLearnerId->setText(QString::number(learnerId));
     
-    QVector<Transaction> transactions = DatabaseManager::instance().getTransactionsByLearnerId(learnerId);
-    populateTransactionsTable(transactions);
+    m_historyLearnerId = learnerId;
+    streamTransactionHistory();
 }
 
 void MainWindow::loadActiveTransactionsForReturn(int learnerId) {
-    QVector<Transaction> transactions = DatabaseManager::instance().getActiveTransactionsByLearnerId(learnerId);
+    QVector<TransactionDetail> transactions =
+        DatabaseManager::instance().getActiveTransactionDetailsByLearner(learnerId);
     populateReturnBooksTable(transactions);
 }
 
 void MainWindow::loadTransactionByBookCode(const QString& bookCode) {
-    Book book = DatabaseManager::instance().getBookByCode(bookCode);
+    QVector<TransactionDetail> activeTransactions =
+        DatabaseManager::instance().getActiveTransactionDetailsByBookCode(bookCode);
     
-    if (book.getId() == -1) {
+    // Only an empty result needs to tell "not borrowed" from "no such book"
+    if (activeTransactions.isEmpty() && DatabaseManager::instance().getBookByCode(bookCode).getId() == -1) {
         showErrorMessage("Book not found");
         return;
     }
     
-    QVector<Transaction> transactions = DatabaseManager::instance().getTransactionsByBookId(book.getId());
-    
-    // Filter for active transactions
-    QVector<Transaction> activeTransactions;
-    for (const Transaction& trans : transactions) {
-        if (trans.isActive()) {
-            activeTransactions.append(trans);
-        }
-    }
-    
     populateReturnBooksTable(activeTransactions);
 }
 
 // ==================== Table Population ====================
 
-void MainWindow::populateBooksTable(const QVector<Book>& books) {
-    ui->tableWidget_books->setRowCount(0);
-    
-    for (const Book& book : books) {
-        int row = ui->tableWidget_books->rowCount();
-        ui->tableWidget_books->insertRow(row);
-        
-        ui->tableWidget_books->setItem(row, 0, new QTableWidgetItem(QString::number(book.getId())));
-        ui->tableWidget_books->setItem(row, 1, new QTableWidgetItem(book.getBookCode()));
-        ui->tableWidget_books->setItem(row, 2, new QTableWidgetItem(book.getTitle()));
-        ui->tableWidget_books->setItem(row, 3, new QTableWidgetItem(book.getAuthor()));
-        ui->tableWidget_books->setItem(row, 4, new QTableWidgetItem(book.getSubject()));
-        ui->tableWidget_books->setItem(row, 5, new QTableWidgetItem(book.getGrade()));
-        ui->tableWidget_books->setItem(row, 6, new QTableWidgetItem("R" + QString::number(book.getPrice(), 'f', 2)));
-        ui->tableWidget_books->setItem(row, 7, new QTableWidgetItem(book.getStatusString()));
-    }
-}
-
-void MainWindow::populateLearnersTable(const QVector<Learner>& learners) {
-    ui->tableWidget_viewLearnersList->setRowCount(0);
-    
-    for (const Learner& learner : learners) {
-        int row = ui->tableWidget_viewLearnersList->rowCount();
-        ui->tableWidget_viewLearnersList->insertRow(row);
-        
-        ui->tableWidget_viewLearnersList->setItem(row, 0, new QTableWidgetItem(QString::number(learner.getId())));
-        ui->tableWidget_viewLearnersList->setItem(row, 1, new QTableWidgetItem(learner.getName()));
-        ui->tableWidget_viewLearnersList->setItem(row, 2, new QTableWidgetItem(learner.getSurname()));
-        ui->tableWidget_viewLearnersList->setItem(row, 3, new QTableWidgetItem(learner.getGrade()));
-        ui->tableWidget_viewLearnersList->setItem(row, 4, new QTableWidgetItem(learner.getDateOfBirth().toString("dd/MM/yyyy")));
-        ui->tableWidget_viewLearnersList->setItem(row, 5, new QTableWidgetItem(learner.getContactNo()));
-    }
-}
-
-void MainWindow::populateTransactionsTable(const QVector<Transaction>& transactions) {
-    ui->tableWidget_transactionHistory->setRowCount(0);
-    
-    for (const Transaction& trans : transactions) {
-        Book book = DatabaseManager::instance().getBookById(trans.getBookId());
-        
-        int row = ui->tableWidget_transactionHistory->rowCount();
-        ui->tableWidget_transactionHistory->insertRow(row);
-        
-        ui->tableWidget_transactionHistory->setItem(row, 0, new QTableWidgetItem(QString::number(trans.getId())));
-        ui->tableWidget_transactionHistory->setItem(row, 1, new QTableWidgetItem(book.getTitle()));
-        ui->tableWidget_transactionHistory->setItem(row, 2, new QTableWidgetItem(trans.getBorrowDate().toString("dd/MM/yyyy")));
-        ui->tableWidget_transactionHistory->setItem(row, 3, new QTableWidgetItem(trans.getDueDate().toString("dd/MM/yyyy")));
-        
-        QString returnDateStr = trans.getReturnDate().isValid() ? 
-                               trans.getReturnDate().toString("dd/MM/yyyy") : "Not Returned";
-        ui->tableWidget_transactionHistory->setItem(row, 4, new QTableWidgetItem(returnDateStr));
-        ui->tableWidget_transactionHistory->setItem(row, 5, new QTableWidgetItem(trans.getStatusString()));
-        
-        QString overdueStr = trans.isOverdue() ? QString::number(trans.getDaysOverdue()) : "-";
-        ui->tableWidget_transactionHistory->setItem(row, 6, new QTableWidgetItem(overdueStr));
-    }
-}
-
-void MainWindow::populateReturnBooksTable(const QVector<Transaction>& transactions) {
+void MainWindow::populateReturnBooksTable(const QVector<TransactionDetail>& transactions) {
     ui->tableWidget_returnBooks->setRowCount(0);
     
-    for (const Transaction& trans : transactions) {
-        Book book = DatabaseManager::instance().getBookById(trans.getBookId());
+    for (const TransactionDetail& detail : transactions) {
+        const Transaction& trans = detail.transaction;
         
         int row = ui->tableWidget_returnBooks->rowCount();
         ui->tableWidget_returnBooks->insertRow(row);
         
         ui->tableWidget_returnBooks->setItem(row, 0, new QTableWidgetItem(QString::number(trans.getId())));
-        ui->tableWidget_returnBooks->setItem(row, 1, new QTableWidgetItem(book.getBookCode()));
-        ui->tableWidget_returnBooks->setItem(row, 2, new QTableWidgetItem(book.getTitle()));
+        ui->tableWidget_returnBooks->setItem(row, 1, new QTableWidgetItem(detail.bookCode));
+        ui->tableWidget_returnBooks->setItem(row, 2, new QTableWidgetItem(detail.bookTitle));
         ui->tableWidget_returnBooks->setItem(row, 3, new QTableWidgetItem(trans.getBorrowDate().toString("dd/MM/yyyy")));
         ui->tableWidget_returnBooks->setItem(row, 4, new QTableWidgetItem(trans.getDueDate().toString("dd/MM/yyyy")));
         
@@ -2083,18 +2274,17 @@ void MainWindow::populateReturnBooksTable(const QVector<Transaction>& transactio
     }
 }
 
-void MainWindow::populateDashboardTransactions(const QVector<Transaction>& transactions) {
+void MainWindow::populateDashboardTransactions(const QVector<TransactionDetail>& transactions) {
     ui->tableWidget_homeRecentTransactions->setRowCount(0);
     
-    for (const Transaction& trans : transactions) {
-        Learner learner = DatabaseManager::instance().getLearnerById(trans.getLearnerId());
-        Book book = DatabaseManager::instance().getBookById(trans.getBookId());
+    for (const TransactionDetail& detail : transactions) {
+        const Transaction& trans = detail.transaction;
         
         int row = ui->tableWidget_homeRecentTransactions->rowCount();
         ui->tableWidget_homeRecentTransactions->insertRow(row);
         
-        ui->tableWidget_homeRecentTransactions->setItem(row, 0, new QTableWidgetItem(learner.getFullName()));
-        ui->tableWidget_homeRecentTransactions->setItem(row, 1, new QTableWidgetItem(book.getTitle()));
+        ui->tableWidget_homeRecentTransactions->setItem(row, 0, new QTableWidgetItem(detail.learnerFullName()));
+        ui->tableWidget_homeRecentTransactions->setItem(row, 1, new QTableWidgetItem(detail.bookTitle));
         ui->tableWidget_homeRecentTransactions->setItem(row, 2, new QTableWidgetItem(trans.getBorrowDate().toString("dd/MM/yyyy")));
         
         QString type = trans.getReturnDate().isValid() ? "Return" : "Borrow";
@@ -2107,9 +2297,10 @@ void MainWindow::populateCurrentlyBorrowedBooks(int learnerId) {
     ui->tableWidget_currentlyBorrowedBooks->setRowCount(0);
     
     QVector<Transaction> activeTransactions = DatabaseManager::instance().getActiveTransactionsByLearnerId(learnerId);
+    QHash<int, Book> books = DatabaseManager::instance().getBooksByIds(bookIdsOf(activeTransactions));
     
     for (const Transaction& trans : activeTransactions) {
-        Book book = DatabaseManager::instance().getBookById(trans.getBookId());
+        Book book = books.value(trans.getBookId());
         
         int row = ui->tableWidget_currentlyBorrowedBooks->rowCount();
         ui->tableWidget_currentlyBorrowedBooks->insertRow(row);
@@ -2127,6 +2318,27 @@ void MainWindow::populateCurrentlyBorrowedBooks(int learnerId) {
     }
 }
 
+// Newest scan first
+void MainWindow::appendScanLedger(const DatabaseManager::ScanReturnResult& result) {
+    if (result.accepted) {
+        ++m_scanAccepted;
+    } else {
+        ++m_scanRejected;
+    }
+
+    ui->tableWidget_scanLedger->insertRow(0);
+    ui->tableWidget_scanLedger->setItem(0, 0, new QTableWidgetItem(QTime::currentTime().toString("hh:mm:ss")));
+    ui->tableWidget_scanLedger->setItem(0, 1, new QTableWidgetItem(result.bookCode));
+    ui->tableWidget_scanLedger->setItem(0, 2, new QTableWidgetItem(result.accepted ? "Returned" : "Rejected"));
+    ui->tableWidget_scanLedger->setItem(0, 3, new QTableWidgetItem(
+        result.accepted ? "Transaction " + QString::number(result.transactionId) : result.error));
+}
+
+void MainWindow::updateScanSummary(int pending) {
+    ui->label_scanSummary->setText(QString("Accepted: %1   Rejected: %2   Pending: %3")
+                                       .arg(m_scanAccepted).arg(m_scanRejected).arg(pending));
+}
+
 // ==================== Form Management ====================
 
 void MainWindow::clearBookForm() {
@@ -2241,13 +2453,15 @@ void MainWindow::searchBooks(const QString& searchTerm) {
         return;
     }
     
-    QVector<Book> books = DatabaseManager::instance().searchBooks(searchTerm);
-    populateBooksTable(books);
+    m_bookModel->setQuery([searchTerm](DatabaseManager& db, const PageCursor& after, int limit) {
+        return db.searchBooksPage(searchTerm, after, limit);
+    });
 }
 
 void MainWindow::filterBooksByGrade(const QString& grade) {
-    QVector<Book> books = DatabaseManager::instance().getBooksByGrade(grade);
-    populateBooksTable(books);
+    m_bookModel->setQuery([grade](DatabaseManager& db, const PageCursor& after, int limit) {
+        return db.getBooksPage(DatabaseManager::BookSort::Title, after, limit, grade);
+    });
 }
 
 void MainWindow::searchLearners(const QString& searchTerm) {
@@ -2256,13 +2470,15 @@ void MainWindow::searchLearners(const QString& searchTerm) {
         return;
     }
     
-    QVector<Learner> learners = DatabaseManager::instance().searchLearners(searchTerm);
-    populateLearnersTable(learners);
+    m_learnerModel->setQuery([searchTerm](DatabaseManager& db, const PageCursor& after, int limit) {
+        return db.searchLearnersPage(searchTerm, after, limit);
+    });
 }
 
 void MainWindow::filterLearnersByGrade(const QString& grade) {
-    QVector<Learner> learners = DatabaseManager::instance().getLearnersByGrade(grade);
-    populateLearnersTable(learners);
+    m_learnerModel->setQuery([grade](DatabaseManager& db, const PageCursor& after, int limit) {
+        return db.getLearnersPage(DatabaseManager::LearnerSort::Surname, after, limit, grade);
+    });
 }
 
 // ==================== Report Generation ====================
@@ -2306,8 +2522,10 @@ QString MainWindow::generateReportHTML(int learnerId, const QString& reportType)
         } else {
             html += "<table><tr><th>Book Code</th><th>Book Title</th><th>Subject</th><th>Author</th><th>Borrow Date</th><th>Due Date</th><th>Status</th></tr>";
             
+            QHash<int, Book> books = DatabaseManager::instance().getBooksByIds(bookIdsOf(activeTransactions));
+
             for (const Transaction& trans : activeTransactions) {
-                Book book = DatabaseManager::instance().getBookById(trans.getBookId());
+                Book book = books.value(trans.getBookId());
                 QString status = trans.isOverdue() ? "OVERDUE" : "Active";
                 
                 html += "<tr>";
@@ -2337,8 +2555,10 @@ QString MainWindow::generateReportHTML(int learnerId, const QString& reportType)
         } else {
             html += "<table><tr><th>Book Code</th><th>Book Title</th><th>Subject</th><th>Borrow Date</th><th>Return Date</th><th>Status</th></tr>";
             
+            QHash<int, Book> books = DatabaseManager::instance().getBooksByIds(bookIdsOf(returnedTransactions));
+
             for (const Transaction& trans : returnedTransactions) {
-                Book book = DatabaseManager::instance().getBookById(trans.getBookId());
+                Book book = books.value(trans.getBookId());
                 
                 html += "<tr>";
                 html += "<td>" + book.getBookCode() + "</td>";
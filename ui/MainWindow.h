@@ -4,10 +4,19 @@
 #include <QMainWindow>
 #include <QTableWidget>
 #include <QStackedWidget>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
 #include "Learner.h"
 #include "Book.h"
 #include "Transaction.h"
 #include "Payments.h"
+#include "DatabaseManager.h"
+#include "ReturnScanQueue.h"
+#include "BackupService.h"
+#include "DomainEvents.h"
+#include "TableModels.h"
 #include <QtCharts/QChartView>
 #include <QtCharts/QPieSeries>
 #include <QtCharts/QPieSlice>
@@ -67,7 +76,6 @@ private slots:
     void on_pushButton_addBookQuickButton_clicked();
     void on_pushButton_issueBookQuickButton_clicked();
     void on_pushButton_returnBookQuickButton_clicked();
-    void setupLibraryChart();
     void displayUserTips();
 
     // ==================== Book Management ====================
@@ -82,7 +90,7 @@ private slots:
     void on_pushButton_markAsLost_clicked();
     void on_lineEdit_searchBooks_textChanged(const QString &text);
     void on_comboBox_sortBooks_currentIndexChanged(int index);
-    void on_tableWidget_books_cellClicked(int row, int column);
+    void on_tableView_books_clicked(const QModelIndex& index);
     
     // Update Book
     void on_pushButton_saveChanges_clicked();
@@ -107,7 +115,7 @@ private slots:
     void on_pushButton_viewLearnerHistory_clicked();
     void on_lineEdit_searchLearner_textChanged(const QString &text);
     void on_comboBox_filterLearnerGrade_currentIndexChanged(int index);
-    void on_tableWidget_viewLearnersList_cellClicked(int row, int column);
+    void on_tableView_viewLearnersList_clicked(const QModelIndex& index);
     
     // Learner Profile
     void on_pushButton_backToLearners_clicked();
@@ -138,12 +146,14 @@ private slots:
     void on_pushButton_goToReportsFromReturn_clicked();
     void on_radioButton_searchByLearner_clicked();
     void on_radioButton_searchByBook_clicked();
+    void on_radioButton_continuousScan_clicked();
     void on_tableWidget_returnBooks_cellClicked(int row, int column);
     
     // Transaction History
     void on_pushButton_BackToLearnersList_clicked();
     void on_pushButton_backToProfile_clicked();
     void on_pushButton_filterHistory_clicked();
+    void on_checkBox_includeArchived_toggled(bool checked);
     void on_pushButton_goToReports_clicked();
 
     // ==================== Reports ====================
@@ -156,6 +166,10 @@ private slots:
     void on_pushButton_backToMenu_clicked();
     void on_radioButton_borrowReport_clicked();
     void on_radioButton_returnReport_clicked();
+    void on_pushButton_importBooks_clicked();
+    void on_pushButton_importLearners_clicked();
+    void on_pushButton_backupNow_clicked();
+    void on_pushButton_restoreBackup_clicked();
 
     // ==================== Payments ====================
     void on_pushButton_findLearnerPayment_clicked();
@@ -164,7 +178,6 @@ private slots:
     void on_pushButton_processPayment_clicked();
     void on_pushButton_viewReceipt_clicked();
     void on_pushButton_clearPayment_clicked();
-    void on_tableWidget_lostBooks_itemSelectionChanged();
 
 private:
     Ui::MainWindow *ui;
@@ -181,6 +194,26 @@ private:
     //Chart
     QChartView *m_chartView;
 
+    // In-flight async loads; a newer request supersedes the older one
+    QFuture<QVector<TransactionDetail>> m_recentFuture;
+    int m_recentRequest;
+
+    // What the streaming books and history tables list
+    DatabaseManager::BookSort m_bookSort;
+    int m_historyLearnerId;
+
+    // Models behind the listing tables; books, learners and history page themselves
+    BookTableModel* m_bookModel;
+    LearnerTableModel* m_learnerModel;
+    TransactionTableModel* m_historyModel;
+    LostBookTableModel* m_lostBookModel;
+    UserTableModel* m_userModel;
+
+    // Continuous return mode
+    ReturnScanQueue* m_returnScanQueue;
+    int m_scanAccepted;
+    int m_scanRejected;
+
     // ==================== Initialization ====================
     void initializeUI();
     void setupConnections();
@@ -219,14 +252,17 @@ private:
     void loadTransactionHistory(int learnerId);
     void loadActiveTransactionsForReturn(int learnerId);
     void loadTransactionByBookCode(const QString& bookCode);
+    void streamTransactionHistory();
+    DatabaseManager::HistoryScope historyScope() const;
+    void loadUsers();
     
     // ==================== Table Population ====================
-    void populateBooksTable(const QVector<Book>& books);
-    void populateLearnersTable(const QVector<Learner>& learners);
-    void populateTransactionsTable(const QVector<Transaction>& transactions);
-    void populateReturnBooksTable(const QVector<Transaction>& transactions);
-    void populateDashboardTransactions(const QVector<Transaction>& transactions);
+    void populateReturnBooksTable(const QVector<TransactionDetail>& transactions);
+    void populateDashboardTransactions(const QVector<TransactionDetail>& transactions);
     void populateCurrentlyBorrowedBooks(int learnerId);
+    void appendScanLedger(const DatabaseManager::ScanReturnResult& result);
+    void updateScanSummary(int pending);
+    void updateBackupStatus(const BackupService::Result& result);
 
     // ==================== Form Management ====================
     void clearBookForm();
@@ -254,11 +290,15 @@ private:
 
     // ==================== UI Updates ====================
     void updateDashboardStats();
+    void setupLibraryChart(const DatabaseManager::DashboardStats& stats);
+    void onDomainChanges(const DomainChanges& changes);
     void updateUserInfo();
     void toggleSidebar();
     void showSuccessMessage(const QString& message);
     void showErrorMessage(const QString& message);
     void showInfoMessage(const QString& message);
+    void showImportProgress(const QString& title, QFutureWatcherBase* watcher,
+                            const std::shared_ptr<std::atomic_bool>& cancelled);
 
     //================== Users ====================================
     void loadUserProfile();
@@ -0,0 +1,117 @@
+#ifndef PAGEDTABLEMODEL_H
+#define PAGEDTABLEMODEL_H
+
+#include <QFuture>
+#include <functional>
+#include "RowTableModel.h"
+#include "AsyncDatabase.h"
+#include "Pagination.h"
+
+// Row model that streams a paged query. setQuery() reads the first page;
+// after that the view asks for the next one through fetchMore() when it is
+// scrolled to the end. Pages run on AsyncDatabase's workers one at a time,
+// and a page still on its way when the query is replaced is dropped.
+//
+// Views size their scrollbar from the loaded rows, so the model also keeps
+// the cheap total the first page came with (see Page::estimatedTotal).
+template <typename Row>
+class PagedTableModel : public RowTableModel<Row> {
+public:
+    using PageQuery = std::function<Page<Row>(DatabaseManager&, const PageCursor& after, int limit)>;
+
+    // Replaces the rows with the query's first page once it arrives
+    void setQuery(const PageQuery& query) {
+        stop();
+        m_query = query;
+        requestPage(true);
+    }
+
+    // Shows a complete set of rows and stops paging
+    void setRows(const QVector<Row>& rows) {
+        stop();
+        RowTableModel<Row>::setRows(rows);
+    }
+
+    bool canFetchMore(const QModelIndex& parent) const override {
+        return !parent.isValid() && m_hasMore && !m_fetching;
+    }
+
+    void fetchMore(const QModelIndex& parent) override {
+        if (canFetchMore(parent)) {
+            requestPage(false);
+        }
+    }
+
+    bool hasMore() const {
+        return m_hasMore;
+    }
+
+    // Rows in all pages: exact once the last page is in, else the first
+    // page's estimate (-1 if there was none)
+    int estimatedRowCount() const {
+        if (!m_hasMore) {
+            return this->rowCount();
+        }
+        return m_estimate < 0 ? -1 : qMax(m_estimate, this->rowCount());
+    }
+
+protected:
+    PagedTableModel(const QStringList& headers, int pageSize, QObject* parent = nullptr)
+        : RowTableModel<Row>(headers, parent)
+        , m_pageSize(pageSize)
+        , m_hasMore(false)
+        , m_fetching(false)
+        , m_estimate(-1)
+        , m_generation(0)
+    {
+    }
+
+private:
+    void stop() {
+        m_future.cancel();
+        ++m_generation;
+        m_query = nullptr;
+        m_cursor = PageCursor();
+        m_hasMore = false;
+        m_fetching = false;
+        m_estimate = -1;
+    }
+
+    void requestPage(bool first) {
+        m_fetching = true;
+        const PageQuery query = m_query;
+        const PageCursor after = m_cursor;
+        const int limit = m_pageSize;
+        m_future = AsyncDatabase::instance().run<Page<Row>>([query, after, limit](DatabaseManager& db) {
+            return query(db, after, limit);
+        });
+
+        const int generation = m_generation;
+        m_future.then(this, [this, generation, first](const Page<Row>& page) {
+            if (generation != m_generation) {
+                return;
+            }
+            // State first, so views reacting to the row signals see it
+            m_fetching = false;
+            m_cursor = page.next;
+            m_hasMore = page.hasMore;
+            if (first) {
+                m_estimate = page.estimatedTotal;
+                RowTableModel<Row>::setRows(page.items);
+            } else {
+                this->appendRows(page.items);
+            }
+        });
+    }
+
+    const int m_pageSize;
+    PageQuery m_query;
+    QFuture<Page<Row>> m_future;
+    PageCursor m_cursor;
+    bool m_hasMore;
+    bool m_fetching;
+    int m_estimate;
+    int m_generation;    // Bumped when the query changes; older pages are dropped
+};
+
+#endif // PAGEDTABLEMODEL_H
@@ -0,0 +1,296 @@
+#ifndef ROWTABLEMODEL_H
+#define ROWTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QCollator>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+// Table model over a vector of listing rows. Cells are formatted in data()
+// only for the rows a view paints, so a table costs one row struct per row
+// rather than one QTableWidgetItem per cell.
+//
+// sort() works like QSortFilterProxyModel's but keys each row once per
+// column (collated strings, raw numbers and dates) and keeps the keys, so
+// rows appended or updated later are placed without re-keying the rest.
+// Sorting by column -1 stops sorting; rows keep their order until reloaded.
+template <typename Row>
+class RowTableModel : public QAbstractTableModel {
+public:
+    static constexpr int IdRole = Qt::UserRole;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : m_rows.size();
+    }
+
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : m_headers.size();
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override {
+        if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < m_headers.size()) {
+            return m_headers.at(section);
+        }
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override {
+        if (!index.isValid() || index.row() >= m_rows.size()) {
+            return QVariant();
+        }
+        const Row& row = m_rows.at(index.row());
+        if (role == Qt::DisplayRole) {
+            return text(row, index.column());
+        }
+        if (role == IdRole) {
+            return idOf(row);
+        }
+        return QVariant();
+    }
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override {
+        if (column < 0 || column >= m_headers.size()) {
+            m_sortColumn = -1;
+            m_keys.clear();
+            return;
+        }
+        if (column != m_sortColumn) {
+            m_sortColumn = column;
+            m_keys.clear();
+            m_keys.reserve(m_rows.size());
+            for (const Row& row : m_rows) {
+                m_keys.push_back(keyOf(row));
+            }
+        }
+        m_sortOrder = order;
+        resort();
+    }
+
+    // ==================== Rows ====================
+
+    void setRows(const QVector<Row>& rows) {
+        beginResetModel();
+        m_rows = rows;
+        m_rowById.clear();
+        if (m_sortColumn >= 0) {
+            m_keys.clear();
+            m_keys.reserve(m_rows.size());
+            for (const Row& row : m_rows) {
+                m_keys.push_back(keyOf(row));
+            }
+            applyOrder(sortedOrder());
+        }
+        endResetModel();
+    }
+
+    void appendRows(const QVector<Row>& rows) {
+        if (rows.isEmpty()) {
+            return;
+        }
+        beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + rows.size() - 1);
+        for (const Row& row : rows) {
+            if (m_sortColumn >= 0) {
+                m_keys.push_back(keyOf(row));
+            }
+            if (!m_rowById.isEmpty()) {
+                m_rowById.insert(idOf(row), m_rows.size());
+            }
+            m_rows.append(row);
+        }
+        endInsertRows();
+        if (m_sortColumn >= 0) {
+            resort();
+        }
+    }
+
+    void clear() {
+        setRows(QVector<Row>());
+    }
+
+    const Row& rowAt(int row) const {
+        return m_rows.at(row);
+    }
+
+    int idAt(int row) const {
+        return row >= 0 && row < m_rows.size() ? idOf(m_rows.at(row)) : -1;
+    }
+
+    // -1 if the id has no loaded row
+    int rowOf(int id) const {
+        if (m_rowById.isEmpty() && !m_rows.isEmpty()) {
+            m_rowById.reserve(m_rows.size());
+            for (int i = 0; i < m_rows.size(); ++i) {
+                m_rowById.insert(idOf(m_rows.at(i)), i);
+            }
+        }
+        return m_rowById.value(id, -1);
+    }
+
+    // The ids from the set that have a loaded row
+    QVector<int> loadedIds(const QSet<int>& ids) const {
+        QVector<int> loaded;
+        for (int id : ids) {
+            if (rowOf(id) >= 0) {
+                loaded.append(id);
+            }
+        }
+        return loaded;
+    }
+
+    // Replaces the loaded row with the same id; false if it is not loaded
+    bool updateRow(const Row& updated) {
+        int row = rowOf(idOf(updated));
+        if (row < 0) {
+            return false;
+        }
+        m_rows[row] = updated;
+        emit dataChanged(index(row, 0), index(row, m_headers.size() - 1), { Qt::DisplayRole });
+        if (m_sortColumn >= 0) {
+            m_keys[row] = keyOf(updated);
+            resort();
+        }
+        return true;
+    }
+
+    void removeIds(const QSet<int>& ids) {
+        QVector<int> rows;
+        for (int id : ids) {
+            int row = rowOf(id);
+            if (row >= 0) {
+                rows.append(row);
+            }
+        }
+        // Bottom up, so the rows still to go keep their index
+        std::sort(rows.begin(), rows.end(), std::greater<int>());
+        for (int row : rows) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_rows.removeAt(row);
+            if (m_sortColumn >= 0) {
+                m_keys.erase(m_keys.begin() + row);
+            }
+            endRemoveRows();
+        }
+        if (!rows.isEmpty()) {
+            m_rowById.clear();
+        }
+    }
+
+protected:
+    explicit RowTableModel(const QStringList& headers, QObject* parent = nullptr)
+        : QAbstractTableModel(parent)
+        , m_headers(headers)
+        , m_sortColumn(-1)
+        , m_sortOrder(Qt::AscendingOrder)
+    {
+        m_collator.setNumericMode(true);
+        m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+    }
+
+    virtual int idOf(const Row& row) const = 0;
+    virtual QString text(const Row& row, int column) const = 0;
+
+    // What a column sorts by. Strings are collated; anything else (numbers,
+    // dates) is compared as a QVariant.
+    virtual QVariant sortValue(const Row& row, int column) const {
+        return text(row, column);
+    }
+
+    const QVector<Row>& rows() const {
+        return m_rows;
+    }
+
+private:
+    struct SortKey {
+        std::optional<QCollatorSortKey> text;
+        QVariant value;
+    };
+
+    SortKey keyOf(const Row& row) const {
+        SortKey key;
+        QVariant value = sortValue(row, m_sortColumn);
+        if (value.typeId() == QMetaType::QString) {
+            key.text = m_collator.sortKey(value.toString());
+        } else {
+            key.value = value;
+        }
+        return key;
+    }
+
+    static bool lessThan(const SortKey& a, const SortKey& b) {
+        if (a.text && b.text) {
+            return a.text->compare(*b.text) < 0;
+        }
+        return QVariant::compare(a.value, b.value) == QPartialOrdering::Less;
+    }
+
+    std::vector<int> sortedOrder() const {
+        std::vector<int> order(m_rows.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (m_sortOrder == Qt::AscendingOrder) {
+            std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+                return lessThan(m_keys[a], m_keys[b]);
+            });
+        } else {
+            std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+                return lessThan(m_keys[b], m_keys[a]);
+            });
+        }
+        return order;
+    }
+
+    // order[i] is the current index of the row that moves to i
+    void applyOrder(const std::vector<int>& order) {
+        QVector<Row> rows;
+        std::vector<SortKey> keys;
+        rows.reserve(m_rows.size());
+        keys.reserve(m_keys.size());
+        for (int from : order) {
+            rows.append(std::move(m_rows[from]));
+            keys.push_back(std::move(m_keys[from]));
+        }
+        m_rows.swap(rows);
+        m_keys.swap(keys);
+        m_rowById.clear();
+    }
+
+    void resort() {
+        std::vector<int> order = sortedOrder();
+        if (std::is_sorted(order.begin(), order.end())) {
+            return;
+        }
+
+        emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+        std::vector<int> moved(order.size());
+        for (int to = 0; to < int(order.size()); ++to) {
+            moved[order[to]] = to;
+        }
+        applyOrder(order);
+
+        // Selections and the current index follow their rows
+        const QModelIndexList from = persistentIndexList();
+        QModelIndexList to;
+        to.reserve(from.size());
+        for (const QModelIndex& index : from) {
+            to.append(this->index(moved[index.row()], index.column()));
+        }
+        changePersistentIndexList(from, to);
+        emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    }
+
+    QStringList m_headers;
+    QVector<Row> m_rows;
+    mutable QHash<int, int> m_rowById;    // Built on first lookup after a change
+    QCollator m_collator;
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+    std::vector<SortKey> m_keys;          // Parallel to m_rows while sorting
+};
+
+#endif // ROWTABLEMODEL_H
@@ -0,0 +1,222 @@
+#include "TableModels.h"
+
+namespace {
+
+const QString kDateFormat = "dd/MM/yyyy";
+
+QString money(double amount) {
+    return "R" + QString::number(amount, 'f', 2);
+}
+
+}
+
+// ==================== Books ====================
+
+BookTableModel::BookTableModel(QObject* parent)
+    : PagedTableModel({ "ID", "Book Code", "Title", "Author", "Subject", "Grade", "Price", "Status" }, 200, parent)
+{
+}
+
+QString BookTableModel::text(const BookListRow& row, int column) const {
+    switch (column) {
+        case 0: return QString::number(row.id);
+        case 1: return row.bookCode;
+        case 2: return row.title;
+        case 3: return row.author;
+        case 4: return row.subject;
+        case 5: return row.grade;
+        case 6: return money(row.price);
+        case 7: return Book::statusToString(row.status);
+    }
+    return QString();
+}
+
+QVariant BookTableModel::sortValue(const BookListRow& row, int column) const {
+    switch (column) {
+        case 0: return row.id;
+        case 6: return row.price;
+    }
+    return text(row, column);
+}
+
+// ==================== Learners ====================
+
+LearnerTableModel::LearnerTableModel(QObject* parent)
+    : PagedTableModel({ "ID", "Name", "Surname", "Grade", "DOB", "Contact" }, 200, parent)
+{
+}
+
+QString LearnerTableModel::text(const Learner& row, int column) const {
+    switch (column) {
+        case 0: return QString::number(row.getId());
+        case 1: return row.getName();
+        case 2: return row.getSurname();
+        case 3: return row.getGrade();
+        case 4: return row.getDateOfBirth().toString(kDateFormat);
+        case 5: return row.getContactNo();
+    }
+    return QString();
+}
+
+QVariant LearnerTableModel::sortValue(const Learner& row, int column) const {
+    switch (column) {
+        case 0: return row.getId();
+        case 4: return row.getDateOfBirth();
+    }
+    return text(row, column);
+}
+
+// ==================== Transaction History ====================
+
+TransactionTableModel::TransactionTableModel(QObject* parent)
+    : PagedTableModel({ "ID", "Book Title", "Borrow Date", "Due Date", "Return Date", "Status", "Days Overdue" }, 100, parent)
+{
+}
+
+QString TransactionTableModel::text(const TransactionDetail& row, int column) const {
+    const Transaction& trans = row.transaction;
+    switch (column) {
+        case 0: return QString::number(trans.getId());
+        case 1: return row.bookTitle;
+        case 2: return trans.getBorrowDate().toString(kDateFormat);
+        case 3: return trans.getDueDate().toString(kDateFormat);
+        case 4: return trans.getReturnDate().isValid() ? trans.getReturnDate().toString(kDateFormat) : "Not Returned";
+        case 5: return trans.getStatusString();
+        case 6: return trans.isOverdue() ? QString::number(trans.getDaysOverdue()) : "-";
+    }
+    return QString();
+}
+
+QVariant TransactionTableModel::sortValue(const TransactionDetail& row, int column) const {
+    const Transaction& trans = row.transaction;
+    switch (column) {
+        case 0: return trans.getId();
+        case 2: return trans.getBorrowDate();
+        case 3: return trans.getDueDate();
+        case 4: return trans.getReturnDate();
+        case 6: return trans.isOverdue() ? trans.getDaysOverdue() : -1;
+    }
+    return text(row, column);
+}
+
+// ==================== Lost Books ====================
+
+LostBookTableModel::LostBookTableModel(QObject* parent)
+    : RowTableModel({ "Transaction ID", "Book Code", "Book Title", "Lost Date", "Amount", "Select" }, parent)
+{
+}
+
+void LostBookTableModel::setRows(const QVector<TransactionDetail>& rows) {
+    m_selected.clear();
+    RowTableModel::setRows(rows);
+}
+
+QString LostBookTableModel::text(const TransactionDetail& row, int column) const {
+    const Transaction& trans = row.transaction;
+    switch (column) {
+        case 0: return QString::number(trans.getId());
+        case 1: return row.bookCode;
+        case 2: return row.bookTitle;
+        // Marking a book lost keeps the loan's return date, if it had one
+        case 3: return trans.getReturnDate().isValid() ? trans.getReturnDate().toString(kDateFormat) : "N/A";
+        case 4: return money(row.bookPrice);
+    }
+    return QString();
+}
+
+QVariant LostBookTableModel::sortValue(const TransactionDetail& row, int column) const {
+    switch (column) {
+        case 0: return row.transaction.getId();
+        case 3: return row.transaction.getReturnDate();
+        case 4: return row.bookPrice;
+    }
+    return text(row, column);
+}
+
+QVariant LostBookTableModel::data(const QModelIndex& index, int role) const {
+    if (role == Qt::CheckStateRole && index.isValid() && index.column() == SelectColumn) {
+        return m_selected.contains(idAt(index.row())) ? Qt::Checked : Qt::Unchecked;
+    }
+    return RowTableModel::data(index, role);
+}
+
+bool LostBookTableModel::setData(const QModelIndex& index, const QVariant& value, int role) {
+    if (role != Qt::CheckStateRole || !index.isValid() || index.column() != SelectColumn) {
+        return false;
+    }
+    const int id = idAt(index.row());
+    if (static_cast<Qt::CheckState>(value.toInt()) == Qt::Checked) {
+        m_selected.insert(id);
+    } else {
+        m_selected.remove(id);
+    }
+    emit dataChanged(index, index, { Qt::CheckStateRole });
+    return true;
+}
+
+Qt::ItemFlags LostBookTableModel::flags(const QModelIndex& index) const {
+    Qt::ItemFlags flags = RowTableModel::flags(index);
+    if (index.isValid() && index.column() == SelectColumn) {
+        flags |= Qt::ItemIsUserCheckable;
+    }
+    return flags;
+}
+
+void LostBookTableModel::setAllSelected(bool selected) {
+    m_selected.clear();
+    if (selected) {
+        for (const TransactionDetail& row : rows()) {
+            m_selected.insert(row.transaction.getId());
+        }
+    }
+    if (rowCount() > 0) {
+        emit dataChanged(index(0, SelectColumn), index(rowCount() - 1, SelectColumn), { Qt::CheckStateRole });
+    }
+}
+
+QVector<int> LostBookTableModel::selectedIds() const {
+    QVector<int> ids;
+    for (const TransactionDetail& row : rows()) {
+        if (m_selected.contains(row.transaction.getId())) {
+            ids.append(row.transaction.getId());
+        }
+    }
+    return ids;
+}
+
+double LostBookTableModel::selectedAmount() const {
+    double amount = 0.0;
+    for (const TransactionDetail& row : rows()) {
+        if (m_selected.contains(row.transaction.getId())) {
+            amount += row.bookPrice;
+        }
+    }
+    return amount;
+}
+
+// ==================== Users ====================
+
+UserTableModel::UserTableModel(QObject* parent)
+    : RowTableModel({ "ID", "Username", "Name", "Surname", "Email", "Contact", "Role" }, parent)
+{
+}
+
+QString UserTableModel::text(const UserListRow& row, int column) const {
+    switch (column) {
+        case 0: return QString::number(row.id);
+        case 1: return row.username;
+        case 2: return row.name;
+        case 3: return row.surname;
+        case 4: return row.email;
+        case 5: return row.contactNo;
+        case 6: return User::roleToString(row.role);
+    }
+    return QString();
+}
+
+QVariant UserTableModel::sortValue(const UserListRow& row, int column) const {
+    if (column == 0) {
+        return row.id;
+    }
+    return text(row, column);
+}
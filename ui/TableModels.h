@@ -0,0 +1,83 @@
+#ifndef TABLEMODELS_H
+#define TABLEMODELS_H
+
+#include "RowTableModel.h"
+#include "PagedTableModel.h"
+#include "Book.h"
+#include "Learner.h"
+#include "Transaction.h"
+#include "User.h"
+
+// Models behind the main window's listing tables. Column 0 of each is the id.
+// Books, learners and loan history stream their rows a page at a time.
+
+class BookTableModel : public PagedTableModel<BookListRow> {
+public:
+    explicit BookTableModel(QObject* parent = nullptr);
+
+protected:
+    int idOf(const BookListRow& row) const override { return row.id; }
+    QString text(const BookListRow& row, int column) const override;
+    QVariant sortValue(const BookListRow& row, int column) const override;
+};
+
+class LearnerTableModel : public PagedTableModel<Learner> {
+public:
+    explicit LearnerTableModel(QObject* parent = nullptr);
+
+protected:
+    int idOf(const Learner& row) const override { return row.getId(); }
+    QString text(const Learner& row, int column) const override;
+    QVariant sortValue(const Learner& row, int column) const override;
+};
+
+// A learner's loan history
+class TransactionTableModel : public PagedTableModel<TransactionDetail> {
+public:
+    explicit TransactionTableModel(QObject* parent = nullptr);
+
+protected:
+    int idOf(const TransactionDetail& row) const override { return row.transaction.getId(); }
+    QString text(const TransactionDetail& row, int column) const override;
+    QVariant sortValue(const TransactionDetail& row, int column) const override;
+};
+
+// Unpaid lost books on the payments page, with a check box per row
+class LostBookTableModel : public RowTableModel<TransactionDetail> {
+public:
+    static constexpr int SelectColumn = 5;
+
+    explicit LostBookTableModel(QObject* parent = nullptr);
+
+    // New rows start unchecked
+    void setRows(const QVector<TransactionDetail>& rows);
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    void setAllSelected(bool selected);
+    // Checked transactions in table order, and what they cost together
+    QVector<int> selectedIds() const;
+    double selectedAmount() const;
+
+protected:
+    int idOf(const TransactionDetail& row) const override { return row.transaction.getId(); }
+    QString text(const TransactionDetail& row, int column) const override;
+    QVariant sortValue(const TransactionDetail& row, int column) const override;
+
+private:
+    QSet<int> m_selected;
+};
+
+class UserTableModel : public RowTableModel<UserListRow> {
+public:
+    explicit UserTableModel(QObject* parent = nullptr);
+
+protected:
+    int idOf(const UserListRow& row) const override { return row.id; }
+    QString text(const UserListRow& row, int column) const override;
+    QVariant sortValue(const UserListRow& row, int column) const override;
+};
+
+#endif // TABLEMODELS_H
@@ -0,0 +1,91 @@
+#include "CsvReader.h"
+
+CsvReader::CsvReader(const QString& filePath, QChar delimiter)
+    : m_file(filePath)
+    , m_delimiter(delimiter)
+    , m_lineNumber(0)
+{
+}
+
+bool CsvReader::open() {
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    // UTF-8 unless the file starts with a BOM saying otherwise
+    m_stream.setDevice(&m_file);
+    m_stream.setEncoding(QStringConverter::Utf8);
+    m_stream.setAutoDetectUnicode(true);
+    return true;
+}
+
+bool CsvReader::readRecord(QStringList& fields) {
+    fields.clear();
+
+    QString line;
+    do {
+        if (!m_stream.readLineInto(&line)) {
+            return false;
+        }
+        ++m_lineNumber;
+    } while (line.trimmed().isEmpty());
+
+    QString field;
+    bool quoted = false;
+    int i = 0;
+
+    while (true) {
+        if (i >= line.size()) {
+            if (quoted) {
+                // Line break inside a quoted field: it continues on the next line
+                field += '\n';
+                if (!m_stream.readLineInto(&line)) {
+                    break;
+                }
+                ++m_lineNumber;
+                i = 0;
+                continue;
+            }
+            break;
+        }
+
+        QChar c = line.at(i++);
+        if (quoted) {
+            if (c == '"') {
+                if (i < line.size() && line.at(i) == '"') {
+                    field += '"';
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == m_delimiter) {
+            fields << field;
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+
+    fields << field;
+    return true;
+}
+
+QString CsvReader::headerKey(const QString& name) {
+    QString key;
+    for (QChar c : name) {
+        if (c.isLetterOrNumber()) {
+            key += c.toLower();
+        }
+    }
+    return key;
+}
+
+qint64 CsvReader::bytesRead() const {
+    // The stream reads ahead in blocks, which is close enough for progress
+    return m_file.pos();
+}
@@ -0,0 +1,40 @@
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+// Reads a CSV file one record at a time (RFC 4180: quoted fields may contain
+// the delimiter, doubled quotes and line breaks). Only the current record is
+// held in memory, so file size does not matter.
+class CsvReader {
+public:
+    explicit CsvReader(const QString& filePath, QChar delimiter = ',');
+
+    bool open();
+    QString errorString() const { return m_error; }
+
+    // False at end of file. Blank lines are skipped.
+    bool readRecord(QStringList& fields);
+
+    // "Book Code", "book_code" and "BOOKCODE" all become "bookcode"
+    static QString headerKey(const QString& name);
+
+    qint64 bytesRead() const;
+    qint64 totalBytes() const { return m_file.size(); }
+    int lineNumber() const { return m_lineNumber; }    // Last physical line read
+
+private:
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+
+    QFile m_file;
+    QTextStream m_stream;
+    QChar m_delimiter;
+    int m_lineNumber;
+    QString m_error;
+};
+
+#endif // CSVREADER_H